@@ -0,0 +1,94 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief Definition of pdep and pext in namespace boolean.
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "sys.h"
+#include "BitOperations.h"
+#include "CpuFeatures.h"
+#ifdef BOOLEAN_EXPRESSION_X86
+#include <immintrin.h>
+#endif
+
+namespace boolean {
+
+namespace {
+
+uint64_t pdep_generic(uint64_t value, uint64_t mask)
+{
+  uint64_t result = 0;
+  for (; mask && value; mask &= mask - 1, value >>= 1)
+    if ((value & 1))
+      result |= lowest_bit(mask);
+  return result;
+}
+
+uint64_t pext_generic(uint64_t value, uint64_t mask)
+{
+  uint64_t result = 0;
+  uint64_t bit = 1;
+  for (; mask; mask &= mask - 1, bit <<= 1)
+    if ((value & lowest_bit(mask)))
+      result |= bit;
+  return result;
+}
+
+#ifdef BOOLEAN_EXPRESSION_X86
+__attribute__((target("bmi2")))
+uint64_t pdep_bmi2(uint64_t value, uint64_t mask)
+{
+  return _pdep_u64(value, mask);
+}
+
+__attribute__((target("bmi2")))
+uint64_t pext_bmi2(uint64_t value, uint64_t mask)
+{
+  return _pext_u64(value, mask);
+}
+#endif
+
+using kernel_type = uint64_t (*)(uint64_t, uint64_t);
+
+} // namespace
+
+uint64_t pdep(uint64_t value, uint64_t mask)
+{
+#ifdef BOOLEAN_EXPRESSION_X86
+  static kernel_type const kernel = CpuFeatures::instance().has(CpuFeatures::bmi2) ? pdep_bmi2 : pdep_generic;
+#else
+  static kernel_type const kernel = pdep_generic;
+#endif
+  return kernel(value, mask);
+}
+
+uint64_t pext(uint64_t value, uint64_t mask)
+{
+#ifdef BOOLEAN_EXPRESSION_X86
+  static kernel_type const kernel = CpuFeatures::instance().has(CpuFeatures::bmi2) ? pext_bmi2 : pext_generic;
+#else
+  static kernel_type const kernel = pext_generic;
+#endif
+  return kernel(value, mask);
+}
+
+} // namespace boolean
@@ -0,0 +1,101 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief Definition of SetBits and bit manipulation helpers in namespace boolean.
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+// Usage:
+//
+// Loops over the variables of a mask that take time proportional to the
+// number of set bits, rather than to the width of the mask.
+//
+// for (int id : SetBits(~product.m_variables))        // The ids of the variables in use, from low to high.
+//   ...
+//
+// // All subsets of mask, starting with (and ending before returning to) zero.
+// uint64_t subset = 0;
+// do
+//   ...
+// while ((subset = next_subset(subset, mask)));
+//
+// pdep and pext use BMI2 when CpuFeatures allows it.
+//
+// uint64_t state = seed;
+// uint64_t r = next_random(state);                     // splitmix64: the same sequence on every platform.
+
+#pragma once
+
+#include <cstdint>
+
+namespace boolean {
+
+// The indices of the set bits of a mask, from least to most significant.
+class SetBits
+{
+ public:
+  class iterator
+  {
+   private:
+    uint64_t m_bits;            // The bits that weren't visited yet.
+
+   public:
+    iterator(uint64_t bits) : m_bits(bits) { }
+
+    int operator*() const { return __builtin_ctzll(m_bits); }
+    iterator& operator++() { m_bits &= m_bits - 1; return *this; }
+
+    friend bool operator==(iterator const& iter1, iterator const& iter2) { return iter1.m_bits == iter2.m_bits; }
+    friend bool operator!=(iterator const& iter1, iterator const& iter2) { return iter1.m_bits != iter2.m_bits; }
+  };
+
+ private:
+  uint64_t m_mask;
+
+ public:
+  explicit SetBits(uint64_t mask) : m_mask(mask) { }
+
+  iterator begin() const { return m_mask; }
+  iterator end() const { return 0; }
+};
+
+// Return the least significant set bit of mask (zero if mask is zero).
+inline uint64_t lowest_bit(uint64_t mask) { return mask & -mask; }
+
+// Return the subset of mask that follows subset when counting in the bits of mask; wraps around to zero.
+inline uint64_t next_subset(uint64_t subset, uint64_t mask) { return (subset - mask) & mask; }
+
+// Deposit the least significant bits of value at the positions of the set bits of mask.
+uint64_t pdep(uint64_t value, uint64_t mask);
+
+// Extract the bits of value at the positions of the set bits of mask into the least significant bits.
+uint64_t pext(uint64_t value, uint64_t mask);
+
+// Advance state and return the next pseudo-random number (splitmix64).
+constexpr uint64_t next_random(uint64_t& state)
+{
+  uint64_t z = (state += 0x9E3779B97F4A7C15);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+  return z ^ (z >> 31);
+}
+
+} // namespace boolean
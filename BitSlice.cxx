@@ -0,0 +1,145 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief Definition of BitSlicedBatch in namespace boolean.
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "sys.h"
+#include "debug.h"
+#include "BitSlice.h"
+#include "BitOperations.h"
+#include <algorithm>
+#include <cstring>
+#include "CpuFeatures.h"
+#ifdef BOOLEAN_EXPRESSION_X86
+#include <immintrin.h>
+#endif
+
+namespace boolean {
+
+namespace {
+
+// Recursive block swap: swap the off-diagonal j x j blocks (with corresponding mask) in each 2j x 2j block, then halve j.
+void transpose64_from(uint64_t matrix[64], int j, uint64_t mask)
+{
+  for (; j != 0; j >>= 1, mask ^= mask << j)
+    for (int block = 0; block < 64; block += 2 * j)
+      for (int k = block; k < block + j; ++k)
+      {
+        uint64_t t = ((matrix[k] >> j) ^ matrix[k + j]) & mask;
+        matrix[k] ^= t << j;
+        matrix[k + j] ^= t;
+      }
+}
+
+void transpose64_generic(uint64_t matrix[64])
+{
+  transpose64_from(matrix, 32, 0x00000000FFFFFFFF);
+}
+
+#ifdef BOOLEAN_EXPRESSION_X86
+__attribute__((target("avx2")))
+void transpose64_avx2(uint64_t matrix[64])
+{
+  uint64_t mask = 0x00000000FFFFFFFF;
+  int j = 32;
+  // Rows k and k + j are always at least four apart for j >= 4; do four rows at a time.
+  for (; j >= 4; j >>= 1, mask ^= mask << j)
+  {
+    __m256i const vmask = _mm256_set1_epi64x(mask);
+    __m128i const shift = _mm_cvtsi32_si128(j);
+    for (int block = 0; block < 64; block += 2 * j)
+      for (int k = block; k < block + j; k += 4)
+      {
+        __m256i low = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(matrix + k));
+        __m256i high = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(matrix + k + j));
+        __m256i t = _mm256_and_si256(_mm256_xor_si256(_mm256_srl_epi64(low, shift), high), vmask);
+        low = _mm256_xor_si256(low, _mm256_sll_epi64(t, shift));
+        high = _mm256_xor_si256(high, t);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(matrix + k), low);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(matrix + k + j), high);
+      }
+  }
+  transpose64_from(matrix, j, mask);
+}
+#endif
+
+} // namespace
+
+void transpose64(uint64_t matrix[64])
+{
+  using kernel_type = void (*)(uint64_t*);
+#ifdef BOOLEAN_EXPRESSION_X86
+  static kernel_type const kernel = CpuFeatures::instance().has(CpuFeatures::avx2) ? transpose64_avx2 : transpose64_generic;
+#else
+  static kernel_type const kernel = transpose64_generic;
+#endif
+  kernel(matrix);
+}
+
+void BitSlicedBatch::load(uint64_t const* rows, size_t number_of_events)
+{
+  ASSERT(number_of_events <= max_events);
+  m_number_of_events = number_of_events;
+  m_number_of_words = (number_of_events + events_per_word - 1) / events_per_word;
+  uint64_t block[events_per_word];
+  for (size_t w = 0; w < m_number_of_words; ++w)
+  {
+    size_t const events = std::min(events_per_word, number_of_events - w * events_per_word);
+    std::memcpy(block, rows + w * events_per_word, events * sizeof(uint64_t));
+    std::fill(block + events, block + events_per_word, 0);
+    transpose64(block);
+    for (size_t id = 0; id < Product::mask_size; ++id)
+      m_columns[id][w] = block[id];
+  }
+}
+
+void BitSlicedBatch::evaluate(Expression const& expression, word_type* result) const
+{
+  size_t const words = m_number_of_words;
+  if (expression.is_literal())
+    std::fill(result, result + words, expression.is_one() ? ~word_type{0} : word_type{0});
+  else
+  {
+    std::fill(result, result + words, word_type{0});
+    for (auto&& term : expression.products())
+    {
+      word_type acc[max_words];
+      std::fill(acc, acc + words, ~word_type{0});
+      for (Variable::id_type id : SetBits(term.care_mask()))
+      {
+        word_type const invert = ((term.negation_mask() >> id) & 1) ? ~word_type{0} : word_type{0};
+        word_type const* column = m_columns[id];
+        for (size_t w = 0; w < words; ++w)
+          acc[w] &= column[w] ^ invert;         // AND for a variable, AND-NOT for a negated variable.
+      }
+      for (size_t w = 0; w < words; ++w)
+        result[w] |= acc[w];
+    }
+  }
+  // Clear the bits of the padding events.
+  size_t const tail = m_number_of_events % events_per_word;
+  if (tail != 0)
+    result[words - 1] &= (word_type{1} << tail) - 1;
+}
+
+} // namespace boolean
@@ -0,0 +1,77 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief Definition of BitSlicedBatch in namespace boolean.
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+// Usage:
+//
+// Events usually arrive as rows: one assignment (bit id is the value of the
+// variable with that id) per event. A BitSlicedBatch stores up to max_events
+// events as columns instead: one word per variable per 64 events. Evaluating
+// a term then costs one AND (or AND-NOT) per variable for 64 events at once.
+//
+// BitSlicedBatch batch;
+// batch.load(rows, number_of_events);
+// BitSlicedBatch::word_type result[BitSlicedBatch::max_words];
+// batch.evaluate(expression, result);  // Bit e of result[w] is the value for event 64 * w + e.
+
+#pragma once
+
+#include "BooleanExpression.h"
+#include <cstdint>
+#include <cstddef>
+
+namespace boolean {
+
+// Transpose a 64x64 bit matrix in place: afterwards bit i of matrix[j] is what was bit j of matrix[i].
+void transpose64(uint64_t matrix[64]);
+
+class BitSlicedBatch
+{
+ public:
+  using word_type = uint64_t;
+  static constexpr size_t events_per_word = 64;
+  static constexpr size_t max_words = 8;
+  static constexpr size_t max_events = max_words * events_per_word;
+
+ private:
+  size_t m_number_of_events;
+  size_t m_number_of_words;
+  word_type m_columns[Product::mask_size][max_words];   // Bit e of m_columns[id][w] is the value of variable id in event 64 * w + e.
+
+ public:
+  BitSlicedBatch() : m_number_of_events(0), m_number_of_words(0) { }
+
+  // Load number_of_events (at most max_events) assignments, one per element of rows.
+  void load(uint64_t const* rows, size_t number_of_events);
+
+  // Write the value of expression for each event to result[0 .. number_of_words() - 1].
+  // Bits of events beyond number_of_events() are zero.
+  void evaluate(Expression const& expression, word_type* result) const;
+
+  size_t number_of_events() const { return m_number_of_events; }
+  size_t number_of_words() const { return m_number_of_words; }
+  word_type const* column(Variable::id_type id) const { return m_columns[id]; }
+};
+
+} // namespace boolean
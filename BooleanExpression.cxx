@@ -26,10 +26,19 @@
 #include "sys.h"
 #include "debug.h"
 #include "BooleanExpression.h"
+#include "BitOperations.h"
 #include "TruthProduct.h"
+#include "CpuFeatures.h"
 #include "utils/macros.h"
 #include <ostream>
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <limits>
+#include <thread>
+#ifdef BOOLEAN_EXPRESSION_X86
+#include <immintrin.h>
+#endif
 
 namespace boolean {
 
@@ -62,20 +71,16 @@ std::string Product::to_string(bool html) const
     };
 
   std::string result;
-  for (Variable::id_type id = 0; id < Product::max_number_of_variables; ++id)
+  for (Variable::id_type id : SetBits(~m_variables))   // The variables that are used.
   {
-    mask_type variable = to_mask(id);
-    if (!(m_variables & variable))      // Is this variable used?
+    bool negated = m_negation & to_mask(id);
+    for (char c : Context::instance()(id).name())
     {
-      bool negated = m_negation & variable;
-      for (char c : Context::instance()(id).name())
-      {
-        if (negated)
-          result += negated_str[i].pre;
-        result += c;
-        if (negated)
-          result += negated_str[i].post;
-      }
+      if (negated)
+        result += negated_str[i].pre;
+      result += c;
+      if (negated)
+        result += negated_str[i].post;
     }
   }
   return result;
@@ -111,7 +116,35 @@ std::string Expression::as_html_string() const
 Variable Context::create_variable(std::string const& name, int user_id)
 {
   auto res = m_variables.emplace(Variable(), VariableData(name, user_id));
-  return res.first->first;
+  Variable const variable = res.first->first;
+  // Does nothing if user_id, respectively name, was already used.
+  m_user_id_index.emplace(user_id, variable);
+  m_name_index.emplace(name, variable);
+  return variable;
+}
+
+Variable const* Context::find_variable(int user_id) const
+{
+  user_id_index_type::const_iterator res = m_user_id_index.find(user_id);
+  return res == m_user_id_index.end() ? nullptr : &res->second;
+}
+
+Variable const* Context::find_variable(std::string const& name) const
+{
+  name_index_type::const_iterator res = m_name_index.find(name);
+  return res == m_name_index.end() ? nullptr : &res->second;
+}
+
+Variable Context::get_or_create_variable(std::string const& name, int user_id)
+{
+  user_id_index_type::const_iterator res = m_user_id_index.find(user_id);
+  return res == m_user_id_index.end() ? create_variable(name, user_id) : res->second;
+}
+
+Variable Context::get_or_create_variable(std::string const& name)
+{
+  name_index_type::const_iterator res = m_name_index.find(name);
+  return res == m_name_index.end() ? create_variable(name) : res->second;
 }
 
 VariableData const& Context::operator()(Variable::id_type id) const
@@ -122,6 +155,94 @@ VariableData const& Context::operator()(Variable::id_type id) const
   return res->second;
 }
 
+namespace {
+
+// The terms are ordered by decreasing number of variables, then by decreasing m_variables and then by decreasing m_negation
+// (the reverse of Expression::less). Digit 0 is the least significant byte of that composite key, digit 16 the most significant.
+int constexpr number_of_digits = 17;
+
+inline unsigned int radix_digit(Product::mask_type variables, Product::mask_type negation, int digit)
+{
+  if (digit < 8)
+    return (~negation >> (8 * digit)) & 0xff;
+  if (digit < 16)
+    return (~variables >> (8 * (digit - 8))) & 0xff;
+  return Product::mask_size - __builtin_popcountll(~variables);
+}
+
+} // namespace
+
+void Expression::sort_terms()
+{
+  size_t const size = m_sum_of_products.size();
+  if (size < radix_sort_threshold)
+  {
+    std::sort(m_sum_of_products.begin(), m_sum_of_products.end(), [](Product const& product1, Product const& product2){ return less(product2, product1); });
+    m_sum_of_products.erase(std::unique(m_sum_of_products.begin(), m_sum_of_products.end()), m_sum_of_products.end());
+  }
+  else
+  {
+    // LSD radix sort. Count all digits in one pass first, so that passes where every term has the same digit
+    // (typically the bytes of unused variables) can be skipped.
+    std::vector<std::array<uint32_t, 256>> count(number_of_digits);
+    for (auto&& counts : count)
+      counts.fill(0);
+    for (auto&& term : m_sum_of_products)
+      for (int digit = 0; digit < number_of_digits; ++digit)
+        ++count[digit][radix_digit(term.m_variables, term.m_negation, digit)];
+    sum_of_products_type buffer(size);
+    sum_of_products_type* from = &m_sum_of_products;
+    sum_of_products_type* to = &buffer;
+    for (int digit = 0; digit < number_of_digits; ++digit)
+    {
+      std::array<uint32_t, 256>& counts(count[digit]);
+      if (counts[radix_digit((*from)[0].m_variables, (*from)[0].m_negation, digit)] == size)
+        continue;               // All terms have the same digit.
+      uint32_t offset = 0;
+      for (auto&& c : counts)
+      {
+        uint32_t n = c;
+        c = offset;
+        offset += n;
+      }
+      for (auto&& term : *from)
+        (*to)[counts[radix_digit(term.m_variables, term.m_negation, digit)]++] = term;
+      std::swap(from, to);
+    }
+    // Copy the result back (if it ended up in buffer), removing duplicates at the same time.
+    size_t n = 0;
+    for (size_t k = 0; k < size; ++k)
+      if (n == 0 || (*from)[k] != m_sum_of_products[n - 1])
+        m_sum_of_products[n++] = (*from)[k];
+    m_sum_of_products.resize(n);
+  }
+}
+
+//static
+Expression Expression::sum_of(std::vector<Product> products)
+{
+  // Remove zeroes; a one makes the whole sum one.
+  size_t non_zero = 0;
+  for (size_t k = 0; k < products.size(); ++k)
+  {
+    if (AI_UNLIKELY(products[k].is_one()))
+      return true;
+    products[non_zero] = products[k];
+    non_zero += products[k].is_zero() ? 0 : 1;
+  }
+  products.resize(non_zero);
+  if (products.empty())
+    return false;
+  Expression result;
+  result.m_sum_of_products = std::move(products);
+  result.sort_terms();
+  result.simplify();
+#ifdef CWDEBUG
+  result.sanity_check();
+#endif
+  return result;
+}
+
 bool Expression::add(Product const& product)
 {
   bool product_is_non_zero = !product.is_zero();
@@ -130,6 +251,7 @@ bool Expression::add(Product const& product)
     sum_of_products_type::iterator insert_point =
       std::find_if(m_sum_of_products.begin(), m_sum_of_products.end(), [&product](Product const& term){ return less(term, product); });
     m_sum_of_products.insert(insert_point, product);
+    m_simplified = false;
   }
   return product_is_non_zero;
 }
@@ -154,6 +276,55 @@ Expression& Expression::operator+=(Product const& product)
   return *this;
 }
 
+namespace {
+
+// Write the non-zero products of the non-literal terms[0...size) with the non-literal product to result,
+// without branches. Return the number of products written.
+size_t multiply_all_generic(Product const* terms, size_t size, Product const& product, Product* result)
+{
+  size_t n = 0;
+  for (size_t k = 0; k < size; ++k)
+  {
+    result[n] = terms[k] * product;
+    n += result[n].is_zero() ? 0 : 1;
+  }
+  return n;
+}
+
+#ifdef BOOLEAN_EXPRESSION_X86
+__attribute__((target("avx2")))
+size_t multiply_all_avx2(Product const* terms, size_t size, Product const& product, Product* result)
+{
+  // Two terms per register, as { m_variables, m_negation } pairs.
+  static_assert(sizeof(Product) == 2 * sizeof(Product::mask_type), "Product must consist of m_variables followed by m_negation.");
+  Product::mask_type const product_variables = product.variables_mask();
+  Product::mask_type const product_negation = product.negation_mask();
+  __m256i const vproduct = _mm256_setr_epi64x(product_variables, product_negation, product_variables, product_negation);
+  __m256i const zero = _mm256_setzero_si256();
+  size_t n = 0;
+  size_t k = 0;
+  for (; k + 2 <= size; k += 2)
+  {
+    __m256i const terms2 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(terms + k));
+    // The product of two non-literals is zero when a variable is used in both (its bit in the OR of
+    // the m_variables is zero) with a different negation. Otherwise it is the AND of both masks.
+    __m256i const either = _mm256_or_si256(terms2, vproduct);
+    __m256i const difference = _mm256_xor_si256(terms2, vproduct);
+    __m256i const conflict = _mm256_andnot_si256(_mm256_unpacklo_epi64(either, either), _mm256_unpackhi_epi64(difference, difference));
+    int const non_zero = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(conflict, zero)));
+    __m256i const products2 = _mm256_and_si256(terms2, vproduct);
+    // Always store, but only advance past the non-zero products.
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(result + n), _mm256_castsi256_si128(products2));
+    n += non_zero & 1;
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(result + n), _mm256_extracti128_si256(products2, 1));
+    n += (non_zero >> 2) & 1;
+  }
+  return n + multiply_all_generic(terms + k, size - k, product, result + n);
+}
+#endif
+
+} // namespace
+
 Expression Expression::operator*(Product const& product) const
 {
   if (AI_UNLIKELY(is_literal() || product.is_literal()))
@@ -162,12 +333,24 @@ Expression Expression::operator*(Product const& product) const
       return false;
     return is_one() ? Expression(product) : copy();
   }
+  using kernel_type = size_t (*)(Product const*, size_t, Product const&, Product*);
+#ifdef BOOLEAN_EXPRESSION_X86
+  static kernel_type const multiply_all = CpuFeatures::instance().has(CpuFeatures::avx2) ? multiply_all_avx2 : multiply_all_generic;
+#else
+  static kernel_type const multiply_all = multiply_all_generic;
+#endif
+  // Multiply all terms and compact out the zeroes in one pass, then sort once.
+  size_t const size = m_sum_of_products.size();
   Expression result;
-  bool non_zero = false;
-  for (auto&& term : m_sum_of_products)
-    non_zero |= result.add(term * product);
-  if (AI_LIKELY(non_zero))
+  sum_of_products_type& products(result.m_sum_of_products);
+  products.resize(size);
+  size_t const non_zero = multiply_all(m_sum_of_products.data(), size, product, products.data());
+  products.resize(non_zero);
+  if (AI_LIKELY(non_zero > 0))
+  {
+    result.sort_terms();
     result.simplify();
+  }
   else
     result = false;
 #ifdef CWDEBUG
@@ -176,6 +359,55 @@ Expression Expression::operator*(Product const& product) const
   return result;
 }
 
+namespace {
+
+using mask_type = Product::mask_type;
+
+// Set bit k % 64 of compatible[k / 64] when the product of the term with masks (used1, negation1) and the term with
+// masks (used2[k], negation2[k]) is not zero: when no variable is used in both with a different negation.
+// The bits for k >= size are cleared.
+void find_compatible_generic(mask_type used1, mask_type negation1, mask_type const* used2, mask_type const* negation2, size_t size, uint64_t* compatible)
+{
+  for (size_t begin = 0; begin < size; begin += 64)
+  {
+    size_t const end = std::min(begin + 64, size);
+    uint64_t word = 0;
+    for (size_t k = begin; k < end; ++k)
+      word |= uint64_t{(used1 & used2[k] & (negation1 ^ negation2[k])) == 0} << (k - begin);
+    compatible[begin / 64] = word;
+  }
+}
+
+#ifdef BOOLEAN_EXPRESSION_X86
+__attribute__((target("avx2")))
+void find_compatible_avx2(mask_type used1, mask_type negation1, mask_type const* used2, mask_type const* negation2, size_t size, uint64_t* compatible)
+{
+  __m256i const vused1 = _mm256_set1_epi64x(used1);
+  __m256i const vnegation1 = _mm256_set1_epi64x(negation1);
+  __m256i const zero = _mm256_setzero_si256();
+  for (size_t begin = 0; begin < size; begin += 64)
+  {
+    size_t const end = std::min(begin + 64, size);
+    uint64_t word = 0;
+    size_t k = begin;
+    // Four terms at a time; the comparison with zero gives one bit per term.
+    for (; k + 4 <= end; k += 4)
+    {
+      __m256i const vused2 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(used2 + k));
+      __m256i const vnegation2 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(negation2 + k));
+      __m256i const conflict = _mm256_and_si256(_mm256_and_si256(vused1, vused2), _mm256_xor_si256(vnegation1, vnegation2));
+      uint64_t const bits = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(conflict, zero)));
+      word |= bits << (k - begin);
+    }
+    for (; k < end; ++k)
+      word |= uint64_t{(used1 & used2[k] & (negation1 ^ negation2[k])) == 0} << (k - begin);
+    compatible[begin / 64] = word;
+  }
+}
+#endif
+
+} // namespace
+
 Expression Expression::times(Expression const& expression) const
 {
   if (AI_UNLIKELY(is_literal() || expression.is_literal()))
@@ -184,13 +416,39 @@ Expression Expression::times(Expression const& expression) const
       return false;
     return is_one() ? expression.copy() : copy();
   }
+  using kernel_type = void (*)(mask_type, mask_type, mask_type const*, mask_type const*, size_t, uint64_t*);
+#ifdef BOOLEAN_EXPRESSION_X86
+  static kernel_type const find_compatible = CpuFeatures::instance().has(CpuFeatures::avx2) ? find_compatible_avx2 : find_compatible_generic;
+#else
+  static kernel_type const find_compatible = find_compatible_generic;
+#endif
+  // Most pairs of terms usually contain a variable with a different negation and multiply to zero.
+  // Filter those out first: for each term, find_compatible tests it against all terms of expression
+  // and returns a bit mask of the pairs that don't multiply to zero. The masks of expression are
+  // copied into separate arrays for that.
+  size_t const size2 = expression.m_sum_of_products.size();
+  std::vector<mask_type> used2(size2);
+  std::vector<mask_type> negation2(size2);
+  for (size_t k = 0; k < size2; ++k)
+  {
+    used2[k] = ~expression.m_sum_of_products[k].m_variables;
+    negation2[k] = expression.m_sum_of_products[k].m_negation;
+  }
+  std::vector<uint64_t> compatible((size2 + 63) / 64);
   Expression result;
-  bool non_zero = false;
+  sum_of_products_type& products(result.m_sum_of_products);
   for (auto&& term1 : m_sum_of_products)
-    for (auto&& term2 : expression.m_sum_of_products)
-      non_zero |= result.add(term1 * term2);
-  if (AI_LIKELY(non_zero))
+  {
+    find_compatible(~term1.m_variables, term1.m_negation, used2.data(), negation2.data(), size2, compatible.data());
+    for (size_t w = 0; w < compatible.size(); ++w)
+      for (int bit : SetBits(compatible[w]))
+        products.push_back(term1 * expression.m_sum_of_products[64 * w + bit]);
+  }
+  if (AI_LIKELY(!products.empty()))
+  {
+    result.sort_terms();
     result.simplify();
+  }
   else
     result = false;
 #ifdef CWDEBUG
@@ -207,17 +465,12 @@ Expression Expression::inverse(Product const& product)
 
   Expression result;
 
-  Product::mask_type const variables = ~product.m_variables;
-  Product::mask_type variable{1};                       // The first variable (with id 0).
-  Product::mask_type constexpr end = (Product::mask_type)1 << 63;    // The 64th variable (with id 63).
-
-  do
+  for (Variable::id_type id : SetBits(~product.m_variables))
   {
-    if (AI_UNLIKELY((variables & variable) != 0))
-      result.m_sum_of_products.emplace_back(~variable, ~(product.m_negation & variable));
-    variable <<= 1;     // Next variable.
+    Product::mask_type const variable = Product::to_mask(id);
+    result.m_sum_of_products.emplace_back(~variable, ~(product.m_negation & variable));
   }
-  while (variable != end);
+  result.m_simplified = true;           // Single variables that are all different.
 
   return result;
 }
@@ -231,6 +484,33 @@ Expression Expression::inverse() const
     if (is_one())
       result = false;
   }
+  else if (is_unate())
+  {
+    // Dualization: the inverse is the sum of the products that contain, for every term, the inverse of one of its
+    // literals. Because every variable has the same negation in all terms, a partial product that already contains
+    // the inverse of a variable of the next term is not changed by it, and no product ever becomes zero: only
+    // absorption is needed (which simplify() does for unate sums).
+    for (auto&& term : m_sum_of_products)
+    {
+      Expression next;
+      for (auto&& partial : result.m_sum_of_products)
+      {
+        if (~partial.m_variables & ~term.m_variables)
+        {
+          next.m_sum_of_products.push_back(partial);
+          continue;
+        }
+        for (Variable::id_type id : SetBits(~term.m_variables))
+        {
+          Product::mask_type const variable = Product::to_mask(id);
+          next.m_sum_of_products.push_back(partial * Product(~variable, ~(term.m_negation & variable)));
+        }
+      }
+      next.sort_terms();
+      next.simplify();
+      result = std::move(next);
+    }
+  }
   else
   {
     for (auto&& term1 : m_sum_of_products)
@@ -267,6 +547,12 @@ Expression Expression::operator()(TruthProduct const& truth_product) const
 }
 
 bool zip(Expression& output, Expression const& expression0, Expression const& expression1)
+{
+  return Expression::zip_with_origin(output, expression0, expression1, nullptr);
+}
+
+//static
+bool Expression::zip_with_origin(Expression& output, Expression const& expression0, Expression const& expression1, origin_type* origin)
 {
   size_t size[2] = { expression0.m_sum_of_products.size(), expression1.m_sum_of_products.size() };
 
@@ -295,9 +581,18 @@ bool zip(Expression& output, Expression const& expression0, Expression const& ex
     //
     // From which we can see that (see http://www.32x8.com/circuits4---A-B-C-D----m-1-8-9-----d-0-3-5-7-10-11-12-13-14-15):
     //   Y = D + A
-    output.m_sum_of_products = *input[expression1.is_one() || expression0.is_zero()];
+    Expression const& copied = (expression1.is_one() || expression0.is_zero()) ? expression1 : expression0;
+    output.m_sum_of_products = copied.m_sum_of_products;
+    output.m_simplified = copied.m_simplified;
     return false;
   }
+  output.m_simplified = false;
+
+  if (origin)
+  {
+    origin->clear();
+    origin->reserve(size[0] + size[1]);
+  }
 
   // Zip the two vectors into eachother so the result is still ordered.
   size_t term_of_input[2] = { 0, 0 }; // The current indices into the vector m_sum_of_products of both inputs.
@@ -307,13 +602,27 @@ bool zip(Expression& output, Expression const& expression0, Expression const& ex
     // Sort large to small (many variables to few), so that when simplify() removes variables from
     // a term we get something that might still combine with a term that it still has to process.
     largest_input = Expression::less(expression0.m_sum_of_products[term_of_input[0]], expression1.m_sum_of_products[term_of_input[1]]) ? 1 : 0;
-    output.m_sum_of_products.push_back((*input[largest_input])[term_of_input[largest_input]]);
+    Product const& term = (*input[largest_input])[term_of_input[largest_input]];
+    output.m_sum_of_products.push_back(term);
+    if (origin)
+    {
+      // Both inputs are simplified, so the only original terms that follow term and that it can simplify with are
+      // the remaining terms of the other input; these are contiguous in that input.
+      int const other_input = 1 - largest_input;
+      Product const* const end = input[other_input]->data() + size[other_input];
+      Product const* other = input[other_input]->data() + term_of_input[other_input];
+      while (other != end && !simplifies_with(term, *other))
+        ++other;
+      origin->push_back(largest_input | (other == end ? isolated : 0));
+    }
   }
   while (++term_of_input[largest_input] < size[largest_input]);
   int remaining_input = 1 - largest_input;        // Only one input left (largest_input is consumed).
   do
   {
     output.m_sum_of_products.push_back((*input[remaining_input])[term_of_input[remaining_input]]);
+    if (origin)
+      origin->push_back(remaining_input | isolated);    // Only terms of the same input follow.
   }
   while (++term_of_input[remaining_input] < size[remaining_input]);
   return true;
@@ -322,12 +631,21 @@ bool zip(Expression& output, Expression const& expression0, Expression const& ex
 Expression operator+(Expression const& expression0, Expression const& expression1)
 {
   Expression output;
-  if (zip(output, expression0, expression1))
-    output.simplify();
+  // If both inputs are simplified, only pairs with one term of each input (and new terms) have to be compared.
+  bool const simplified_inputs = expression0.m_simplified && expression1.m_simplified;
+#ifdef CWDEBUG
+  // This is quadratic, so only check it when all invariants are checked on every call.
+  if (Expression::s_sanity_check_level.load(std::memory_order_relaxed) == Expression::sanity_check_full)
+    ASSERT(!simplified_inputs || (expression0.is_irreducible() && expression1.is_irreducible()));
+#endif
+  Expression::origin_type origin;
+  Expression::origin_type* const origin_ptr = simplified_inputs ? &origin : nullptr;
+  if (Expression::zip_with_origin(output, expression0, expression1, origin_ptr))
+    output.simplify(origin_ptr);
   return output;
 }
 
-bool Product::is_single_negation_different_from(Product const& product)
+bool Product::is_single_negation_different_from(Product const& product) const
 {
   mask_type negation_difference = m_negation ^ product.m_negation;
   return m_variables == product.m_variables &&                          // The same variables are used in both products.
@@ -335,7 +653,7 @@ bool Product::is_single_negation_different_from(Product const& product)
          (((negation_difference - 1) & negation_difference) == 0);      // There is exactly one negation difference (also true when there are none).
 }
 
-bool Product::includes_all_of(Product const& product)
+bool Product::includes_all_of(Product const& product) const
 {
   mask_type negation_difference = m_negation ^ product.m_negation;
   return (m_variables | product.m_variables) == product.m_variables &&  // Common variables are equal to variables in product, aka all
@@ -343,7 +661,7 @@ bool Product::includes_all_of(Product const& product)
          !(negation_difference & ~product.m_variables);                 // None of those variables have a different negation.
 }
 
-bool Product::has_different_negation_for_single_variable(Product const& product)
+bool Product::has_different_negation_for_single_variable(Product const& product) const
 {
   if (((product.m_variables + 1) | product.m_variables) == full_mask && // Is product just a single variable?
       (m_variables | product.m_variables) != full_mask)
@@ -376,7 +694,97 @@ Product Product::remove_variable(Product const& product, Product const& variable
   return result;
 }
 
-bool Expression::insert_after(Product const& term, int after, int& size, int& first_removed)
+Expression::OriginIndex::OriginIndex(origin_type* origin) : m_origin(origin)
+{
+  if (!origin)
+    return;
+  int number_of_unknown = 0;
+  for (int position = 0; position < static_cast<int>(origin->size()); ++position)
+  {
+    uint8_t const input = (*origin)[position] & input_mask;
+    if (input == unknown_input)
+      ++number_of_unknown;
+    else
+      m_positions[input].push_back(position);
+  }
+  // Terms of input 0 and 1 are not compared with terms of an unknown input.
+  ASSERT(number_of_unknown == 0 || (m_positions[0].empty() && m_positions[1].empty()));
+}
+
+void Expression::OriginIndex::insert(int position)
+{
+  for (auto& positions : m_positions)
+    for (auto iter = std::lower_bound(positions.begin(), positions.end(), position); iter != positions.end(); ++iter)
+      ++*iter;
+  std::vector<int>& new_terms(m_positions[new_term]);
+  new_terms.insert(std::lower_bound(new_terms.begin(), new_terms.end(), position), position);
+  m_origin->insert(m_origin->begin() + position, new_term);
+}
+
+class Expression::Candidates
+{
+ private:
+  std::vector<int>::const_iterator m_next[2];   // The next position in each of the lists that are merged.
+  std::vector<int>::const_iterator m_end[2];
+  int m_number_of_lists;                        // The number of lists to merge, or -1 to visit every position.
+  int m_j;                                      // The current position.
+
+ public:
+  Candidates(OriginIndex const* index, int i) : m_number_of_lists(-1), m_j(i + 1)
+  {
+    if (!index)
+      return;
+    uint8_t const origin_i = (*index->m_origin)[i];
+    uint8_t const input_i = origin_i & input_mask;
+    std::vector<int> const* lists[2];
+    if ((origin_i & isolated))
+    {
+      lists[0] = &index->m_positions[new_term];
+      m_number_of_lists = 1;
+    }
+    else if (input_i < new_term)
+    {
+      lists[0] = &index->m_positions[1 - input_i];
+      lists[1] = &index->m_positions[new_term];
+      m_number_of_lists = 2;
+    }
+    else
+      return;
+    for (int l = 0; l < m_number_of_lists; ++l)
+    {
+      m_next[l] = std::upper_bound(lists[l]->begin(), lists[l]->end(), i);
+      m_end[l] = lists[l]->end();
+    }
+    set_current();
+  }
+
+  int operator*() const { return m_j; }
+
+  Candidates& operator++()
+  {
+    if (m_number_of_lists < 0)
+      ++m_j;
+    else
+    {
+      for (int l = 0; l < m_number_of_lists; ++l)
+        if (m_next[l] != m_end[l] && *m_next[l] == m_j)
+          ++m_next[l];
+      set_current();
+    }
+    return *this;
+  }
+
+ private:
+  void set_current()
+  {
+    m_j = std::numeric_limits<int>::max();
+    for (int l = 0; l < m_number_of_lists; ++l)
+      if (m_next[l] != m_end[l] && *m_next[l] < m_j)
+        m_j = *m_next[l];
+  }
+};
+
+bool Expression::insert_after(Product const& term, int after, int& size, int& first_removed, OriginIndex* index)
 {
   DoutEntering(dc::boolean_simplify, "insert_after(" << term << ", " << after << ", ...)");
   sum_of_products_type::iterator iter = m_sum_of_products.begin() + (after + 1);
@@ -389,6 +797,8 @@ bool Expression::insert_after(Product const& term, int after, int& size, int& fi
     {
       // Insert term before the first element that is less than term.
       m_sum_of_products.insert(iter, term);
+      if (index)
+        index->insert(j);
       ++size;
       break;
     }
@@ -421,7 +831,7 @@ bool Expression::insert_after(Product const& term, int after, int& size, int& fi
       Product common_factor = Product::common_factor(m_sum_of_products[i], term);
       m_sum_of_products[i].m_variables = 0;   // Remove i.
       m_sum_of_products[j].m_variables = 0;   // Remove j.
-      if (first_removed < 0) first_removed = i;
+      if (i < first_removed) first_removed = i;
       if (common_factor.is_one())
       {
         // A + A' is true;
@@ -429,9 +839,8 @@ bool Expression::insert_after(Product const& term, int after, int& size, int& fi
         Dout(dc::boolean_simplify, "result: " << *this);
         return true;
       }
-      if (insert_after(common_factor, j, size, first_removed))       // Insert common_factor after j.
-        return true;
-      continue;
+      // The common factor takes over the role of term (it is compared with all other terms when it is inserted).
+      return insert_after(common_factor, j, size, first_removed, index);       // Insert common_factor after j.
     }
     if (m_sum_of_products[i].has_different_negation_for_single_variable(term))
     {
@@ -439,8 +848,13 @@ bool Expression::insert_after(Product const& term, int after, int& size, int& fi
       Product shorter_term = Product::remove_variable(m_sum_of_products[i], term);
       m_sum_of_products[i].m_variables = 0;   // Remove i.
       if (i < first_removed) first_removed = i;
-      if (insert_after(shorter_term, i, size, first_removed))        // Insert shorter_term after i.
+      if (insert_after(shorter_term, i, size, first_removed, index))        // Insert shorter_term after i.
         return true;
+      // That might have inserted terms before term, or removed term.
+      while (j < size && m_sum_of_products[j] != term)
+        ++j;
+      if (j == size)
+        return false;
       continue;
     }
     if (m_sum_of_products[i].includes_all_of(term))
@@ -451,15 +865,55 @@ bool Expression::insert_after(Product const& term, int after, int& size, int& fi
       continue;
     }
   }
+  // Also test it with all terms after it: the new term can be inserted before the term that simplify() is at
+  // (when it was created by an insert_after that was called from here), in which case simplify() won't get to it.
+  for (int k = j + 1; k < size; ++k)
+  {
+    if (!m_sum_of_products[k].m_variables)      // Removed?
+      continue;
+    Dout(dc::boolean_simplify, "Comparing " << term << " with " << m_sum_of_products[k]);
+    if (term.is_single_negation_different_from(m_sum_of_products[k]))
+    {
+      Dout(dc::boolean_simplify, "Removing both because only the negation of a single variable is different.");
+      Product common_factor = Product::common_factor(term, m_sum_of_products[k]);
+      m_sum_of_products[j].m_variables = 0;   // Remove j.
+      m_sum_of_products[k].m_variables = 0;   // Remove k.
+      if (j < first_removed) first_removed = j;
+      if (common_factor.is_one())
+      {
+        // A + A' is true;
+        *this = true;
+        Dout(dc::boolean_simplify, "result: " << *this);
+        return true;
+      }
+      return insert_after(common_factor, k, size, first_removed, index);       // Insert common_factor after k.
+    }
+    if (term.has_different_negation_for_single_variable(m_sum_of_products[k]))
+    {
+      Dout(dc::boolean_simplify, "Removing the first because it contains the single variable of the second but with a different negation.");
+      Product shorter_term = Product::remove_variable(term, m_sum_of_products[k]);
+      m_sum_of_products[j].m_variables = 0;   // Remove j.
+      if (j < first_removed) first_removed = j;
+      return insert_after(shorter_term, j, size, first_removed, index);        // Insert shorter_term after j.
+    }
+    if (term.includes_all_of(m_sum_of_products[k]))
+    {
+      Dout(dc::boolean_simplify, "Removing the first because it includes all of the second.");
+      m_sum_of_products[j].m_variables = 0;   // Remove j.
+      if (j < first_removed) first_removed = j;
+      return false;
+    }
+  }
   return false;
 }
 
-void Expression::simplify()
+void Expression::simplify(origin_type* origin)
 {
   DoutEntering(dc::boolean_simplify, "Expression::simplify() [this = " << *this << "]");
   int size = m_sum_of_products.size();
   // An empty vector means the Expression is undefined!
   ASSERT(size > 0);
+  m_simplified = true;
   if (size == 1)
   {
     Dout(dc::boolean_simplify, "No simplification possible.");
@@ -476,16 +930,34 @@ void Expression::simplify()
   //
   // Here ABC and XYZ stand for 'any boolean product', while just A and D stand for a single indeterminate boolean Variable.
 
+  // The first two simplifications require a variable that occurs both negated and not negated.
+  // If there is none then only absorption has to be checked, and no new terms are added.
+  bool const unate = is_unate();
+
+  OriginIndex origin_index(origin);
+  OriginIndex* const index = origin ? &origin_index : nullptr;
   int first_removed = -1;
   for (int i = 0; i < size - 1; ++i)
   {
     if (!m_sum_of_products[i].m_variables)      // Removed?
       continue;
-    for (int j = i + 1; j < size; ++j)
+    for (Candidates candidate(index, i); *candidate < size; ++candidate)
     {
+      int const j = *candidate;
       if (!m_sum_of_products[j].m_variables)    // Removed?
         continue;
       Dout(dc::boolean_simplify, "Comparing " << m_sum_of_products[i] << " with " << m_sum_of_products[j]);
+      if (unate)
+      {
+        if (m_sum_of_products[i].includes_all_of(m_sum_of_products[j]))
+        {
+          Dout(dc::boolean_simplify, "Removing the first because it includes all of the second.");
+          m_sum_of_products[i].m_variables = 0; // Remove i.
+          if (first_removed < 0) first_removed = i;
+          break;
+        }
+        continue;
+      }
       if (m_sum_of_products[i].is_single_negation_different_from(m_sum_of_products[j])) // Ie, i = A'BCD' and j = A'BC'D' (only negation of C is different).
       {
         Dout(dc::boolean_simplify, "Removing both because only the negation of a single variable is different.");
@@ -501,7 +973,7 @@ void Expression::simplify()
           Dout(dc::boolean_simplify, "result: " << *this);
           return;
         }
-        if (insert_after(common_factor, j, size, first_removed))     // Insert common_factor after j.
+        if (insert_after(common_factor, j, size, first_removed, index))     // Insert common_factor after j.
           return;
         break;
       }
@@ -511,7 +983,7 @@ void Expression::simplify()
         Product shorter_term = Product::remove_variable(m_sum_of_products[i], m_sum_of_products[j]);
         m_sum_of_products[i].m_variables = 0;   // Remove i.
         if (first_removed < 0) first_removed = i;
-        if (insert_after(shorter_term, i, size, first_removed))      // Insert shorter_term after i.
+        if (insert_after(shorter_term, i, size, first_removed, index))      // Insert shorter_term after i.
           return;
         break;
       }
@@ -537,6 +1009,50 @@ void Expression::simplify()
   Dout(dc::boolean_simplify, "result: " << *this);
 }
 
+void Expression::simplify_parallel(unsigned int number_of_threads)
+{
+  int const size = m_sum_of_products.size();
+  if (size < parallel_simplify_threshold || number_of_threads < 2)
+  {
+    simplify();
+    return;
+  }
+
+  // Mark every term that does not simplify with any of the terms that follow it.
+  // simplify() then only compares those terms with the terms that it creates itself
+  // (through the list of new terms of OriginIndex), and never visits the original terms
+  // after them. Since simplify() only ever inserts terms and marks terms as removed, the
+  // original terms that follow a term i stay a subset of the ones that are tested here,
+  // so skipping them does not change what simplify() does.
+  origin_type origin(size, unknown_input);
+  int constexpr chunk_size = 64;
+  std::atomic<int> next_chunk{0};
+  auto worker = [this, size, &origin, &next_chunk]()
+  {
+    for (int begin = next_chunk.fetch_add(chunk_size); begin < size; begin = next_chunk.fetch_add(chunk_size))
+    {
+      int const end = std::min(begin + chunk_size, size);
+      for (int i = begin; i < end; ++i)
+      {
+        Product const& term_i(m_sum_of_products[i]);
+        bool simplifies = false;
+        for (int j = i + 1; j < size && !simplifies; ++j)
+          simplifies = simplifies_with(term_i, m_sum_of_products[j]);
+        if (!simplifies)
+          origin[i] |= isolated;
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (unsigned int t = 1; t < number_of_threads; ++t)
+    threads.emplace_back(worker);
+  worker();
+  for (auto&& thread : threads)
+    thread.join();
+
+  simplify(&origin);
+}
+
 #ifdef CWDEBUG
 bool Product::is_sane() const
 {
@@ -560,7 +1076,46 @@ bool Product::is_sane() const
   return true;
 }
 
+//static
+void Expression::set_sanity_check_level(sanity_check_level_type level, unsigned int sampling_rate)
+{
+  ASSERT(sampling_rate > 0);
+  s_sanity_check_sampling_rate = sampling_rate;
+  s_sanity_check_level = level;
+}
+
 void Expression::sanity_check() const
+{
+  int const level = s_sanity_check_level.load(std::memory_order_relaxed);
+  if (level == sanity_check_none)
+    return;
+  if (level == sanity_check_full)
+  {
+    check_all_invariants();
+    return;
+  }
+  if (level == sanity_check_cheap)
+    check_cheap_invariants();
+  if (s_sanity_check_calls++ % s_sanity_check_sampling_rate.load(std::memory_order_relaxed) == 0)
+    check_all_invariants();
+}
+
+// Check the first and last term, and the order of the first and last two terms.
+void Expression::check_cheap_invariants() const
+{
+  ASSERT(!m_sum_of_products.empty());
+  ASSERT(m_sum_of_products[0].is_sane());
+  ASSERT(!m_sum_of_products[0].is_literal() || m_sum_of_products.size() == 1);
+  size_t const size = m_sum_of_products.size();
+  if (size == 1)
+    return;
+  ASSERT(m_sum_of_products[size - 1].is_sane());
+  ASSERT(!m_sum_of_products[size - 1].is_literal());
+  ASSERT(less(m_sum_of_products[1], m_sum_of_products[0]));
+  ASSERT(less(m_sum_of_products[size - 1], m_sum_of_products[size - 2]));
+}
+
+void Expression::check_all_invariants() const
 {
   ASSERT(!m_sum_of_products.empty());
   ASSERT(m_sum_of_products[0].is_sane());
@@ -578,11 +1133,50 @@ void Expression::sanity_check() const
     ASSERT(!less(*iter, *next));
   }
 }
+
+bool Expression::is_irreducible() const
+{
+  for (size_t i = 0; i < m_sum_of_products.size(); ++i)
+    for (size_t j = i + 1; j < m_sum_of_products.size(); ++j)
+      if (simplifies_with(m_sum_of_products[i], m_sum_of_products[j]))
+        return false;
+  return true;
+}
 #endif
 
+Signature Expression::signature() const
+{
+  // Bit-parallel evaluation of all assignments at once.
+  Signature result(false);
+  for (auto&& product : m_sum_of_products)
+  {
+    if (product.is_literal())
+    {
+      if (product.is_one())
+        result = true;
+      continue;
+    }
+    Signature::words_type term;
+    term.fill(Product::full_mask);
+    for (Variable::id_type id : SetBits(~product.m_variables))
+    {
+      Signature::words_type const& column = Signature::column(id);
+      mask_type invert = (product.m_negation & Product::to_mask(id)) ? Product::full_mask : Product::empty_mask;
+      for (size_t w = 0; w < Signature::number_of_words; ++w)
+        term[w] &= column[w] ^ invert;
+    }
+    for (size_t w = 0; w < Signature::number_of_words; ++w)
+      result.words()[w] |= term[w];
+  }
+  return result;
+}
+
 // Brute force comparison of two boolean expressions.
 bool Expression::equivalent(Expression const& expression) const
 {
+  // Different signatures prove that the expressions are not equivalent.
+  if (signature() != expression.signature())
+    return false;
   mask_type all_variables = 0;
   for (auto&& product : m_sum_of_products)
     if (!product.is_literal())
@@ -590,51 +1184,81 @@ bool Expression::equivalent(Expression const& expression) const
   for (auto&& product : expression.m_sum_of_products)
     if (!product.is_literal())
       all_variables |= ~product.m_variables;
-  int number_of_variables = 0;
-  int variable_id[Product::max_number_of_variables];
-  for (Variable::id_type id = 0; id < Product::max_number_of_variables; ++id)
+  // Try every subset of all_variables as the set of true variables.
+  mask_type set_variables = 0;
+  do
   {
-    mask_type bit = Product::to_mask(id);
-    if ((all_variables & bit))
-      variable_id[number_of_variables++] = id;
+    if (evaluate(set_variables) != expression.evaluate(set_variables))
+      return false;
   }
-  // Now we can find back the bit(mask) of a variable with: Product::to_mask(variable_id[variable]).
-  int number_of_permutations = 1 << number_of_variables;
-  for (int permutation = 0; permutation < number_of_permutations; ++permutation)
+  while ((set_variables = next_subset(set_variables, all_variables)));
+  return true;
+}
+
+void Expression::polarity(mask_type& positive, mask_type& negative) const
+{
+  positive = negative = 0;
+  if (is_literal())
+    return;
+  for (auto&& product : m_sum_of_products)
   {
-    mask_type set_variables = 0;
-    for (int variable = 0; variable < number_of_variables; ++variable)
-    {
-      int permbit = 1 << variable;
-      if ((permutation & permbit))
-        set_variables |= Product::to_mask(variable_id[variable]);
-    }
-    bool result1 = is_one();
-    if (!is_literal())
-    {
-      result1 = false;
-      for (auto&& product : m_sum_of_products)
-        if ((~product.m_variables & (set_variables ^ product.m_negation)) == ~product.m_variables)
-        {
-          result1 = true;
-          break;
-        }
-    }
-    bool result2 = expression.is_one();
-    if (!expression.is_literal())
+    positive |= ~product.m_variables & ~product.m_negation;
+    negative |= ~product.m_variables & product.m_negation;
+  }
+}
+
+bool Expression::is_tautology() const
+{
+  if (is_literal())
+    return is_one();
+  // A unate sum of products that is not one has a false assignment: set every variable to the opposite of its
+  // negation in the terms; then every term contains a false literal.
+  if (is_unate())
+    return false;
+  return equivalent(s_one);
+}
+
+bool Expression::is_symmetric_in(Variable v1, Variable v2) const
+{
+  mask_type const variable1 = Product(v1).care_mask();
+  mask_type const variable2 = Product(v2).care_mask();
+  if (variable1 == variable2 || is_literal())
+    return true;
+  mask_type const both = variable1 | variable2;
+  if (is_unate())
+  {
+    // After absorption a unate sum of products is the (unique) sum of all its prime implicants.
+    // Compare that with the one of the expression with both variables swapped.
+    Expression simplified = copy();
+    simplified.simplify();
+    Expression swapped;
+    for (Product term : simplified.m_sum_of_products)
     {
-      result2 = false;
-      for (auto&& product : expression.m_sum_of_products)
-        if ((~product.m_variables & (set_variables ^ product.m_negation)) == ~product.m_variables)
-        {
-          result2 = true;
-          break;
-        }
+      // Swap the bits of both variables in both masks.
+      if (((term.m_variables & variable1) != 0) != ((term.m_variables & variable2) != 0))
+        term.m_variables ^= both;
+      if (((term.m_negation & variable1) != 0) != ((term.m_negation & variable2) != 0))
+        term.m_negation ^= both;
+      swapped.m_sum_of_products.push_back(term);
     }
-    if (result1 != result2)
-      return false;
+    swapped.sort_terms();
+    swapped.simplify();
+    return swapped == simplified;
   }
-  return true;
+  // Compare the cofactors for v1 = 1, v2 = 0 and v1 = 0, v2 = 1.
+  Expression const cofactor10 = (*this)(TruthProduct(Product(~both, ~both | variable2)));
+  Expression const cofactor01 = (*this)(TruthProduct(Product(~both, ~both | variable1)));
+  return cofactor10.equivalent(cofactor01);
+}
+
+bool Expression::evaluate(mask_type set_variables) const
+{
+  if (is_literal())
+    return is_one();
+  for (auto&& product : m_sum_of_products)
+    if (product.evaluate(set_variables))
+      return true;
+  return false;
 }
 
 //static
@@ -644,6 +1268,14 @@ Variable::id_type Variable::s_next_id;
 Expression Expression::s_zero(false);
 //static
 Expression Expression::s_one(true);
+#ifdef CWDEBUG
+//static
+std::atomic<int> Expression::s_sanity_check_level{sanity_check_full};
+//static
+std::atomic<unsigned int> Expression::s_sanity_check_sampling_rate{64};
+//static
+thread_local unsigned int Expression::s_sanity_check_calls;
+#endif
 
 namespace {
 
@@ -33,6 +33,8 @@
 // Variable A{context.create_variable("A")};
 // Variable B{context.create_variable("B")};
 // Variable C{context.create_variable("C")};
+// Variable D{context.get_or_create_variable("D", 42)};   // Returns the same Variable every time it is called with user_id 42.
+// Variable const* c = context.find_variable("C");         // nullptr if no Variable with that name was created.
 //
 // // Construct single variable "Products" from variables.
 //
@@ -63,20 +65,73 @@
 // f = e.times(f);              // !A * B * !D. Must explicitely use 'times()' to multiply two Expressions.
 // e = !_ab;                    // A + !B
 // f = f.inverse();             // A + !B + D. Must explicitely use 'inverse()' to calculate the inverse of an Expression.
+//
+// // Reading the terms of an Expression in place.
+//
+// for (Product const& term : e.products())
+//   if ((values & term.care_mask()) == term.value_mask())
+//     ...
+//
+// // Properties.
+//
+// e.is_unate();                // true: no variable occurs both negated and not negated in A + !B.
+// e.is_symmetric_in(A, B);     // false: !A + B is not equivalent to A + !B.
+// e.is_tautology();            // false.
 
 #pragma once
 
+#include "Signature.h"
 #include "utils/Singleton.h"
 #include <iosfwd>
 #include <string>
 #include <map>
+#include <unordered_map>
+#ifdef CWDEBUG
+#include <atomic>
+#endif
+#if __has_include(<span>)
+#include <span>
+#endif
 
 namespace boolean {
 
+#ifdef __cpp_lib_span
+template<typename T>
+using Span = std::span<T>;
+#else
+// The subset of std::span (C++20) that is needed here.
+template<typename T>
+class Span
+{
+ private:
+  T* m_data;
+  size_t m_size;
+
+ public:
+  Span(T* data, size_t size) : m_data(data), m_size(size) { }
+
+  T* data() const { return m_data; }
+  size_t size() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+  T* begin() const { return m_data; }
+  T* end() const { return m_data + m_size; }
+  T& operator[](size_t index) const { return m_data[index]; }
+  T& front() const { return m_data[0]; }
+  T& back() const { return m_data[m_size - 1]; }
+};
+#endif
+
 class Context;
 class Product;
 class Expression;
 class TruthProduct;
+class IncrementalMatcher;
+class EvaluationOrder;
+class BitSlicedBatch;
+class ExternalSimplifier;
+class TimesGenerator;
+class InverseGenerator;
+class SizeEstimator;
 
 // Data associated with a boolean variable.
 class VariableData
@@ -102,6 +157,7 @@ class Variable
 
  private:
   friend class Product;
+  friend class IncrementalMatcher;
   id_type m_id;                 // A unique identifier for this variable.
   static id_type s_next_id;     // The id to use for the next Variable that is created (this code is not thread-safe).
 
@@ -125,9 +181,13 @@ class Context : public Singleton<Context>
  public:
   using VariableKey = Variable;
   using variables_type = std::map<VariableKey, VariableData>;
+  using user_id_index_type = std::unordered_map<int, Variable>;
+  using name_index_type = std::unordered_map<std::string, Variable>;
 
  private:
   variables_type m_variables;
+  user_id_index_type m_user_id_index;   // The first Variable that was created for each user_id.
+  name_index_type m_name_index;         // The first Variable that was created for each name.
 
  private:
   Context() { }
@@ -137,6 +197,14 @@ class Context : public Singleton<Context>
  public:
   Variable create_variable(std::string const& name, int user_id = 0);
   VariableData const& operator()(Variable::id_type id) const;
+
+  // Return the first Variable that was created with user_id, respectively name, or nullptr if there is none.
+  Variable const* find_variable(int user_id) const;
+  Variable const* find_variable(std::string const& name) const;
+
+  // Return the first Variable that was created with user_id, respectively name; create it if it doesn't exist yet.
+  Variable get_or_create_variable(std::string const& name, int user_id);
+  Variable get_or_create_variable(std::string const& name);
 };
 
 // A product is a catenation of logical AND-ed boolean variables, ie
@@ -222,6 +290,14 @@ class Product
   // Construct a Product directly from two masks (for internal use only; but public because it is called from a header of the std library).
   explicit Product(mask_type variables, mask_type negation) : m_variables(variables), m_negation(negation) { ASSERT(is_sane()); }
 
+  // Read-only access to the two masks that encode this Product (see m_variables and m_negation).
+  mask_type variables_mask() const { return m_variables; }
+  mask_type negation_mask() const { return m_negation; }
+
+  // A non-zero Product is true for the variables whose bit is set in values iff (values & care_mask()) == value_mask().
+  mask_type care_mask() const { return ~m_variables; }
+  mask_type value_mask() const { return ~m_variables & ~m_negation; }
+
 #ifdef CWDEBUG
   bool is_sane() const;
 #endif
@@ -293,10 +369,17 @@ class Product
     return count;
   }
 
+  // Return the value of this Product when the variables whose bit is set in set_variables are true and all other variables are false.
+  bool evaluate(mask_type set_variables) const
+  {
+    // Each variable in use must be true when not negated and false when negated.
+    return !is_zero() && (~m_variables & (set_variables ^ m_negation)) == ~m_variables;
+  }
+
  private:
-  bool is_single_negation_different_from(Product const& product);
-  bool includes_all_of(Product const& product);
-  bool has_different_negation_for_single_variable(Product const& product);
+  bool is_single_negation_different_from(Product const& product) const;
+  bool includes_all_of(Product const& product) const;
+  bool has_different_negation_for_single_variable(Product const& product) const;
   static Product common_factor(Product const& product1, Product const& product2);
   static Product remove_variable(Product const& product, Product const& variable);
 
@@ -309,6 +392,12 @@ class Product
   friend bool operator!=(Product const& product1, Product const& product2)
       { return product1.m_variables != product2.m_variables || product1.m_negation != product2.m_negation; }
   friend Product operator*(Product lhs, Product const& rhs) { lhs *= rhs; return lhs; }
+
+  size_t hash() const
+  {
+    mask_type h = (m_variables ^ (m_negation * 0x9E3779B97F4A7C15)) * 0xBF58476D1CE4E5B9;
+    return static_cast<size_t>(h ^ (h >> 31));
+  }
 };
 
 //inline
@@ -327,8 +416,14 @@ class Expression
  protected:
   using sum_of_products_type = std::vector<Product>;
   sum_of_products_type m_sum_of_products;       // Elements must have a unique set of variables (Product::m_variables) and be ordered.
+  bool m_simplified = false;                    // Set when no two terms simplify with each other (by simplify()); add() and zip() reset it.
   static Expression s_zero;
   static Expression s_one;
+#ifdef CWDEBUG
+  static std::atomic<int> s_sanity_check_level;
+  static std::atomic<unsigned int> s_sanity_check_sampling_rate;
+  static thread_local unsigned int s_sanity_check_calls;       // Per thread, so that sampling doesn't contend on one cache line.
+#endif
 
   // Used for ordering m_sum_of_products.
   static bool less(Product const& product1, Product const& product2)
@@ -344,18 +439,71 @@ class Expression
               product1.m_negation < product2.m_negation)));
   }
 
+  // For each term, which input of operator+ it came from (0 or 1), unknown_input if it is not known to come from an
+  // already simplified input, or new_term if it was created by simplify. Original terms that are known not to simplify
+  // with any original term that follows them additionally have the bit isolated set.
+  using origin_type = std::vector<uint8_t>;
+  static constexpr uint8_t new_term = 2;
+  static constexpr uint8_t unknown_input = 3;
+  static constexpr uint8_t input_mask = 3;
+  static constexpr uint8_t isolated = 4;
+
+  // The positions of the terms of input 0, of input 1 and of the new terms, in increasing order.
+  // Kept up to date (together with the origin) when simplify() inserts a new term.
+  struct OriginIndex
+  {
+    origin_type* m_origin;
+    std::vector<int> m_positions[3];            // Indexed by the input (0 or 1), or new_term.
+
+    OriginIndex(origin_type* origin);           // Does nothing if origin is nullptr.
+    void insert(int position);                  // Register a new term that was inserted at position.
+  };
+
+  // Iterates over the positions, in increasing order, of the terms after term i that simplify() has to compare it with.
+  class Candidates;
+
+  // Return true if term_i + term_j simplifies, where term_i precedes term_j.
+  static bool simplifies_with(Product const& term_i, Product const& term_j)
+  {
+    return term_i.is_single_negation_different_from(term_j) ||
+           term_i.has_different_negation_for_single_variable(term_j) ||
+           term_i.includes_all_of(term_j);
+  }
+
   // Used by simplify.
-  bool insert_after(Product const& term, int after, int& size, int& first_removed);
+  bool insert_after(Product const& term, int after, int& size, int& first_removed, OriginIndex* index);
+  // If origin is non-null, an isolated term is only compared with new terms, and other terms of input 0 or 1 only
+  // with new terms and the terms of the other input. Terms of an unknown input and new terms are compared with all terms.
+  void simplify(origin_type* origin);
+
+  // Sort the terms in the order that add() keeps them in (and that simplify() needs) and remove duplicates.
+  // Uses a radix sort on the key (number of variables, m_variables, m_negation) for radix_sort_threshold or more terms.
+  void sort_terms();
+  static constexpr size_t radix_sort_threshold = 256;
+
+  // Same as zip(output, expression0, expression1) but also fills origin, including the isolated bits.
+  static bool zip_with_origin(Expression& output, Expression const& expression0, Expression const& expression1, origin_type* origin);
+
+ private:
+#ifdef CWDEBUG
+  // Used by sanity_check().
+  void check_cheap_invariants() const;
+  void check_all_invariants() const;
+  // Return true if no two terms simplify with each other.
+  bool is_irreducible() const;
+#endif
 
  public:
   Expression() { }
-  Expression(Expression&& expression) : m_sum_of_products(std::move(expression.m_sum_of_products)) { }
-  Expression& operator=(Expression&& expression) { m_sum_of_products = std::move(expression.m_sum_of_products); return *this; }
-  Expression& operator=(Product const& product) { m_sum_of_products.resize(1); m_sum_of_products[0] = product; return *this; }
-  Expression& operator=(bool literal) { m_sum_of_products.resize(1); m_sum_of_products[0] = Product{literal}; return *this; }
-  explicit Expression(Product const& product) : m_sum_of_products(1, product) { }
-  Expression(bool literal) : m_sum_of_products(1, Product(literal)) { }
-  Expression copy() const { Expression result; result.m_sum_of_products = m_sum_of_products; return result; }
+  Expression(Expression&& expression) : m_sum_of_products(std::move(expression.m_sum_of_products)), m_simplified(expression.m_simplified) { }
+  Expression& operator=(Expression&& expression) { m_sum_of_products = std::move(expression.m_sum_of_products); m_simplified = expression.m_simplified; return *this; }
+  Expression& operator=(Product const& product) { m_sum_of_products.resize(1); m_sum_of_products[0] = product; m_simplified = true; return *this; }
+  Expression& operator=(bool literal) { m_sum_of_products.resize(1); m_sum_of_products[0] = Product{literal}; m_simplified = true; return *this; }
+  explicit Expression(Product const& product) : m_sum_of_products(1, product), m_simplified(true) { }
+  Expression(bool literal) : m_sum_of_products(1, Product(literal)), m_simplified(true) { }
+  Expression copy() const { Expression result; result.m_sum_of_products = m_sum_of_products; result.m_simplified = m_simplified; return result; }
+  // Construct the sum of an unordered batch of products.
+  static Expression sum_of(std::vector<Product> products);
   Expression times(Expression const& expression) const;
   Expression inverse() const;
   Expression operator()(TruthProduct const& truth_product) const;
@@ -365,6 +513,8 @@ class Expression
   // Same as operator+(Expression const& expression0, Expression const& expression1) but without call to simplify.
   friend bool zip(Expression& output, Expression const& expression0, Expression const& expression1);
 
+  // If both inputs are simplified (the result of simplify(), or of an operation that calls it) then only pairs with
+  // one term of each input (and new terms) are compared; otherwise (after add() or zip()) all pairs are.
   friend Expression operator+(Expression const& expression0, Expression const& expression1);
   Expression& operator+=(Expression const& expression) { *this = *this + expression; return *this; }
 
@@ -374,8 +524,21 @@ class Expression
   Expression& operator+=(Product const& product);
 
   Expression operator*(Product const& product) const;
-  void simplify();
+  void simplify() { simplify(nullptr); }
+  // Same as simplify() (with the exact same result) but uses number_of_threads threads to find the terms that can be skipped.
+  void simplify_parallel(unsigned int number_of_threads);
+  static constexpr int parallel_simplify_threshold = 1024;     // simplify_parallel calls simplify() for smaller sums.
 #ifdef CWDEBUG
+  // How much checking sanity_check() does; it is called after every operation.
+  enum sanity_check_level_type
+  {
+    sanity_check_none,          // No checks at all.
+    sanity_check_sampled,       // Check all invariants on one in sampling_rate calls.
+    sanity_check_cheap,         // Check the invariants that take constant time on every call, and all invariants on one in sampling_rate calls.
+    sanity_check_full           // Check all invariants on every call (the default).
+  };
+  // Calls are counted per thread for the sampling.
+  static void set_sanity_check_level(sanity_check_level_type level, unsigned int sampling_rate = 64);
   void sanity_check() const;
 #endif
 
@@ -385,13 +548,38 @@ class Expression
   bool is_one() const { return m_sum_of_products[0].is_one(); }
   bool is_product() const { return m_sum_of_products.size() == 1; }
   bool is_initialized() const { return !m_sum_of_products.empty(); }
+
+  // Read-only view of the terms, in order. Zero and one are represented by a single (literal) term.
+  // The view is invalidated by any change to this Expression.
+  Span<Product const> products() const { return { m_sum_of_products.data(), m_sum_of_products.size() }; }
   bool equivalent(Expression const& expression) const;
+
+  // Set positive to the variables that occur not negated in at least one term, and negative to those that occur negated.
+  void polarity(mask_type& positive, mask_type& negative) const;
+  // Return true if no variable occurs both negated and not negated. For such expressions simplify() only has to
+  // check absorption, inverse() uses dualization and is_tautology() is trivial.
+  bool is_unate() const { mask_type positive, negative; polarity(positive, negative); return !(positive & negative); }
+  // Return true if this Expression is true for every assignment.
+  bool is_tautology() const;
+  // Return true if swapping v1 and v2 gives an equivalent Expression.
+  bool is_symmetric_in(Variable v1, Variable v2) const;
+
+  // Return the value of this Expression when the variables whose bit is set in set_variables are true and all other variables are false.
+  bool evaluate(mask_type set_variables) const;
+
+  // Return the values of this Expression under Signature::number_of_assignments fixed pseudo-random assignments.
+  // Expressions with a different signature are not equivalent. The result is not cached: store it when it is
+  // needed more than once (for example as hash key), and recalculate it after changing the Expression.
+  Signature signature() const;
   std::string as_html_string() const;
   Product const& as_product() const { ASSERT(is_product()); return m_sum_of_products[0]; }
 
  //private:
   static Expression inverse(Product const& product);
 
+  // Sorts its runs with sort_terms() and merges them with less(), which requires moving each run into
+  // m_sum_of_products. Such a run is never simplified, so m_simplified stays false.
+  friend class ExternalSimplifier;
   friend std::ostream& operator<<(std::ostream& os, Expression const& expression);
   friend bool operator==(Expression const& expression1, Expression const& expression2) { return expression1.m_sum_of_products == expression2.m_sum_of_products; }
   friend bool operator!=(Expression const& expression1, Expression const& expression2) { return !(expression1.m_sum_of_products == expression2.m_sum_of_products); }
@@ -405,6 +593,16 @@ Expression Product::operator!() const
 
 } // namespace boolean
 
+namespace std {
+
+template<>
+struct hash<boolean::Product>
+{
+  size_t operator()(boolean::Product const& product) const { return product.hash(); }
+};
+
+} // namespace std
+
 #ifdef CWDEBUG
 NAMESPACE_DEBUG_CHANNELS_START
 extern channel_ct boolean_simplify;
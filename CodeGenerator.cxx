@@ -0,0 +1,164 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief Definition of CodeGenerator in namespace boolean.
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "sys.h"
+#include "debug.h"
+#include "CodeGenerator.h"
+#include "BitOperations.h"
+#include "TruthProduct.h"
+#include <ostream>
+#include <cstdio>
+
+namespace boolean {
+
+namespace {
+
+std::string hex(Product::mask_type mask)
+{
+  char buf[32];
+  std::snprintf(buf, sizeof(buf), "0x%016llxULL", static_cast<unsigned long long>(mask));
+  return buf;
+}
+
+} // namespace
+
+void CodeGenerator::add(std::string const& function_name, Expression const& expression)
+{
+  ASSERT(expression.is_initialized());
+  m_functions.push_back({ function_name, expression.copy() });
+}
+
+void CodeGenerator::write(std::ostream& os, style_type style) const
+{
+  os << "// Generated by boolean-expression CodeGenerator; do not edit.\n"
+        "//\n"
+        "// Bit id of the argument `values' is the value of the variable with that id.\n"
+        "\n"
+        "#pragma once\n"
+        "\n"
+        "#include <cstdint>\n"
+        "\n"
+        "namespace " << m_namespace << " {\n";
+  if (style == masked_compare)
+  {
+    os << "\nnamespace masks {\n";
+    for (auto&& function : m_functions)
+      write_masks(os, function);
+    os << "\n} // namespace masks\n";
+  }
+  for (auto&& function : m_functions)
+  {
+    os << "\n// " << function.m_expression << "\n";
+    os << "inline bool " << function.m_name << "(uint64_t values)\n{\n";
+    if (style == masked_compare)
+      write_masked_compare(os, function, "  ");
+    else
+    {
+      int nodes = 0;
+      write_decision_tree(os, function.m_expression, 0, nodes);
+    }
+    os << "}\n";
+  }
+  os << "\n} // namespace " << m_namespace << "\n";
+}
+
+void CodeGenerator::write_masks(std::ostream& os, Function const& function) const
+{
+  Expression const& expression(function.m_expression);
+  if (expression.is_literal())
+    return;
+  os << "\ninline constexpr int " << function.m_name << "_size = " << expression.products().size() << ";\n";
+  os << "inline constexpr uint64_t " << function.m_name << "_care[" << function.m_name << "_size] = {\n";
+  for (auto&& term : expression.products())
+    os << "  " << hex(term.care_mask()) << ",\t// " << term << '\n';
+  os << "};\n";
+  os << "inline constexpr uint64_t " << function.m_name << "_value[" << function.m_name << "_size] = {\n";
+  for (auto&& term : expression.products())
+    os << "  " << hex(term.value_mask()) << ",\n";
+  os << "};\n";
+}
+
+void CodeGenerator::write_masked_compare(std::ostream& os, Function const& function, std::string const& indent) const
+{
+  Expression const& expression(function.m_expression);
+  if (expression.is_literal())
+  {
+    os << indent << "return " << (expression.is_one() ? "true" : "false") << ";\n";
+    return;
+  }
+  std::string const prefix = "masks::" + function.m_name;
+  // Use a bitwise OR to avoid a branch per term.
+  os << indent << "bool result = false;\n";
+  os << indent << "for (int i = 0; i < " << prefix << "_size; ++i)\n";
+  os << indent << "  result |= (values & " << prefix << "_care[i]) == " << prefix << "_value[i];\n";
+  os << indent << "return result;\n";
+}
+
+void CodeGenerator::write_decision_tree(std::ostream& os, Expression const& expression, int depth, int& nodes) const
+{
+  std::string const indent(2 * (depth + 1), ' ');
+  if (expression.is_literal())
+  {
+    os << indent << "return " << (expression.is_one() ? "true" : "false") << ";\n";
+    return;
+  }
+  if (expression.is_product() || nodes >= max_tree_nodes)
+  {
+    // Leaf: compare the remaining terms directly.
+    os << indent << "return";
+    // Use a bitwise OR to avoid a branch per term.
+    std::string separator = " ";
+    for (auto&& term : expression.products())
+    {
+      os << separator << "((values & " << hex(term.care_mask()) << ") == " << hex(term.value_mask()) << ')';
+      separator = " |\n" + indent + "      ";
+    }
+    os << ";\t// " << expression << '\n';
+    return;
+  }
+  ++nodes;
+  // Split on the variable that occurs in the most terms.
+  int count[Product::max_number_of_variables] = {};
+  for (auto&& term : expression.products())
+    for (Variable::id_type id : SetBits(term.care_mask()))
+      ++count[id];
+  Variable::id_type id = 0;
+  for (Variable::id_type i = 1; i < Product::max_number_of_variables; ++i)
+    if (count[i] > count[id])
+      id = i;
+  mask_type const bit = mask_type{1} << id;
+  Expression const if_true = expression(TruthProduct(~bit, ~bit));
+  Expression const if_false = expression(TruthProduct(~bit, Product::full_mask));
+  os << indent << "if ((values & " << hex(bit) << "))\t// " << Context::instance()(id).name() << '\n';
+  os << indent << "{\n";
+  write_decision_tree(os, if_true, depth + 1, nodes);
+  os << indent << "}\n";
+  os << indent << "else\n";
+  os << indent << "{\n";
+  write_decision_tree(os, if_false, depth + 1, nodes);
+  os << indent << "}\n";
+}
+
+} // namespace boolean
@@ -0,0 +1,99 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief Definition of CodeGenerator in namespace boolean.
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+// Usage:
+//
+// A CodeGenerator writes a standalone C++ header with one inline function
+// per Expression, that evaluates the Expression for a given assignment
+// (bit id of the argument is the value of the variable with that id).
+//
+// CodeGenerator generator("rules");
+// generator.add("is_spam", e1);
+// generator.add("is_urgent", e2);
+// std::ofstream header("rules.h");
+// generator.write(header, CodeGenerator::masked_compare);
+//
+// The generated header only depends on <cstdint> and can be included in
+// any number of translation units (it requires C++17 for inline variables):
+//
+// namespace rules {
+// inline bool is_spam(uint64_t values) { ... }
+// ...
+// }
+//
+// In masked_compare style each term is a constexpr (care, value) mask pair and the function
+// ORs (values & care) == value over all terms without branches.
+// In decision_tree style the function is a tree of if/else on single variables (Shannon expansion);
+// subtrees that would become larger than max_tree_nodes fall back to masked_compare.
+
+#pragma once
+
+#include "BooleanExpression.h"
+#include <string>
+#include <vector>
+#include <iosfwd>
+
+namespace boolean {
+
+class CodeGenerator
+{
+ public:
+  using mask_type = Product::mask_type;
+
+  enum style_type
+  {
+    masked_compare,
+    decision_tree
+  };
+
+  static constexpr int max_tree_nodes = 4096;   // Maximum number of if/else nodes per function in decision_tree style.
+
+ private:
+  struct Function
+  {
+    std::string m_name;
+    Expression m_expression;
+  };
+
+  std::string m_namespace;
+  std::vector<Function> m_functions;
+
+ public:
+  // The generated functions are put in namespace namespace_name.
+  CodeGenerator(std::string const& namespace_name) : m_namespace(namespace_name) { }
+
+  // Add a function function_name that evaluates expression; function_name must be a valid C++ identifier.
+  void add(std::string const& function_name, Expression const& expression);
+
+  // Write the header to os.
+  void write(std::ostream& os, style_type style) const;
+
+ private:
+  void write_masks(std::ostream& os, Function const& function) const;
+  void write_masked_compare(std::ostream& os, Function const& function, std::string const& indent) const;
+  void write_decision_tree(std::ostream& os, Expression const& expression, int depth, int& nodes) const;
+};
+
+} // namespace boolean
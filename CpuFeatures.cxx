@@ -0,0 +1,109 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief Definition of CpuFeatures in namespace boolean.
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "sys.h"
+#include "debug.h"
+#include "CpuFeatures.h"
+#include <cstdlib>
+#include <cstring>
+
+namespace boolean {
+
+namespace {
+
+struct FeatureName
+{
+  CpuFeatures::features_type m_feature;
+  char const* m_name;
+};
+
+FeatureName const s_feature_names[] = {
+  { CpuFeatures::popcnt, "popcnt" },
+  { CpuFeatures::sse4_2, "sse4.2" },
+  { CpuFeatures::avx2, "avx2" },
+  { CpuFeatures::avx512f, "avx512f" },
+  { CpuFeatures::bmi2, "bmi2" }
+};
+
+} // namespace
+
+CpuFeatures::CpuFeatures() : m_detected(0)
+{
+#ifdef BOOLEAN_EXPRESSION_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("popcnt"))
+    m_detected |= popcnt;
+  if (__builtin_cpu_supports("sse4.2"))
+    m_detected |= sse4_2;
+  if (__builtin_cpu_supports("avx2"))
+    m_detected |= avx2;
+  if (__builtin_cpu_supports("avx512f"))
+    m_detected |= avx512f;
+  if (__builtin_cpu_supports("bmi2"))
+    m_detected |= bmi2;
+#endif
+  m_features = m_detected;
+
+  char const* override = std::getenv("BOOLEAN_EXPRESSION_CPU");
+  if (override)
+  {
+    features_type allowed = 0;
+    for (char const* name = override; *name;)
+    {
+      size_t const length = std::strcspn(name, ",");
+      for (auto&& feature_name : s_feature_names)
+        if (std::strlen(feature_name.m_name) == length && std::strncmp(name, feature_name.m_name, length) == 0)
+          allowed |= feature_name.m_feature;
+      name += length;
+      if (*name == ',')
+        ++name;
+    }
+    m_features &= allowed;
+  }
+  Dout(dc::notice, "CpuFeatures: detected " << to_string(m_detected) << "; using " << to_string(m_features) << '.');
+}
+
+//static
+CpuFeatures const& CpuFeatures::instance()
+{
+  static CpuFeatures const s_instance;
+  return s_instance;
+}
+
+//static
+std::string CpuFeatures::to_string(features_type features)
+{
+  std::string result;
+  for (auto&& feature_name : s_feature_names)
+    if ((features & feature_name.m_feature))
+    {
+      if (!result.empty())
+        result += ',';
+      result += feature_name.m_name;
+    }
+  return result.empty() ? "generic" : result;
+}
+
+} // namespace boolean
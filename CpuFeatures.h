@@ -0,0 +1,84 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief Definition of CpuFeatures in namespace boolean.
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+// Usage:
+//
+// The instruction set extensions of the CPU that we run on, detected once.
+// Kernels that have a faster version for some extension are compiled for
+// every version (using a target attribute) and pick one the first time
+// they are called:
+//
+// using kernel_type = void (*)(uint64_t*);
+// static kernel_type const kernel = CpuFeatures::instance().has(CpuFeatures::avx2) ? kernel_avx2 : kernel_generic;
+// kernel(data);
+//
+// The environment variable BOOLEAN_EXPRESSION_CPU restricts the features
+// that are used, for example to benchmark the different versions with
+// the same binary. Its value is a comma separated list of feature names
+// (popcnt, sse4.2, avx2, avx512f, bmi2), or "generic" for none of them.
+// Features that the CPU doesn't have are never used.
+//
+// BOOLEAN_EXPRESSION_CPU=generic ./program      # Only use the generic kernels.
+// BOOLEAN_EXPRESSION_CPU=bmi2 ./program         # Use BMI2 but not AVX2.
+
+#pragma once
+
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BOOLEAN_EXPRESSION_X86 1
+#endif
+
+namespace boolean {
+
+class CpuFeatures
+{
+ public:
+  using features_type = unsigned int;
+  static constexpr features_type popcnt = 1;
+  static constexpr features_type sse4_2 = 2;
+  static constexpr features_type avx2 = 4;
+  static constexpr features_type avx512f = 8;
+  static constexpr features_type bmi2 = 16;
+
+ private:
+  features_type m_detected;     // The features that the CPU has.
+  features_type m_features;     // The features that may be used.
+
+  CpuFeatures();
+
+ public:
+  static CpuFeatures const& instance();
+
+  // Return true if all of features may be used.
+  bool has(features_type features) const { return (m_features & features) == features; }
+  features_type detected() const { return m_detected; }
+  features_type features() const { return m_features; }
+
+  // Return the names of features as a comma separated list, or "generic".
+  static std::string to_string(features_type features);
+};
+
+} // namespace boolean
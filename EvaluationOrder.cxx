@@ -0,0 +1,82 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief Definition of EvaluationOrder in namespace boolean.
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "sys.h"
+#include "debug.h"
+#include "EvaluationOrder.h"
+#include <algorithm>
+#include <numeric>
+
+namespace boolean {
+
+EvaluationOrder::EvaluationOrder(Expression const& expression) : m_evaluations(0), m_literal_value(false)
+{
+  ASSERT(expression.is_initialized());
+  if (expression.is_literal())
+    m_literal_value = expression.is_one();
+  else
+    m_terms.assign(expression.products().begin(), expression.products().end());
+  m_hits.resize(m_terms.size(), 0);
+}
+
+bool EvaluationOrder::profile(mask_type set_variables)
+{
+  ++m_evaluations;
+  bool result = m_literal_value;
+  for (size_t i = 0; i < m_terms.size(); ++i)
+    if (m_terms[i].evaluate(set_variables))
+    {
+      ++m_hits[i];
+      result = true;
+    }
+  return result;
+}
+
+void EvaluationOrder::reorder()
+{
+  std::vector<size_t> order(m_terms.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [this](size_t i1, size_t i2){
+      return m_hits[i1] > m_hits[i2] ||
+             (m_hits[i1] == m_hits[i2] && m_terms[i1].number_of_variables() < m_terms[i2].number_of_variables());
+    });
+  std::vector<Product> terms(m_terms.size());
+  std::vector<uint64_t> hits(m_hits.size());
+  for (size_t i = 0; i < order.size(); ++i)
+  {
+    terms[i] = m_terms[order[i]];
+    hits[i] = m_hits[order[i]];
+  }
+  m_terms.swap(terms);
+  m_hits.swap(hits);
+}
+
+void EvaluationOrder::reset_statistics()
+{
+  m_evaluations = 0;
+  std::fill(m_hits.begin(), m_hits.end(), 0);
+}
+
+} // namespace boolean
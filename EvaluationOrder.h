@@ -0,0 +1,89 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief Definition of EvaluationOrder in namespace boolean.
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+// Usage:
+//
+// Evaluating a sum of products stops at the first term that is true,
+// so it is fastest to test the terms that are most often true first.
+// The order of Expression::products() is determined by simplify()
+// and can not be changed; an EvaluationOrder holds a copy of the terms
+// in an order that can be tuned to the actual input.
+//
+// EvaluationOrder order(expression);
+// for (auto values : training_set)
+//   order.profile(values);     // Evaluate while gathering statistics.
+// order.reorder();             // Put the terms that are true most often first.
+// ...
+// bool result = order(values); // Same as expression.evaluate(values).
+
+#pragma once
+
+#include "BooleanExpression.h"
+#include <vector>
+#include <cstdint>
+
+namespace boolean {
+
+class EvaluationOrder
+{
+ public:
+  using mask_type = Product::mask_type;
+
+ private:
+  std::vector<Product> m_terms;         // The terms of the Expression, in evaluation order.
+  std::vector<uint64_t> m_hits;         // For each term in m_terms, the number of profiled evaluations for which it was true.
+  uint64_t m_evaluations;               // The number of profiled evaluations.
+  bool m_literal_value;                 // The value of the Expression if m_terms is empty (the Expression is a literal).
+
+ public:
+  // Initially the terms are in the same order as in expression.
+  explicit EvaluationOrder(Expression const& expression);
+
+  // Evaluate without gathering statistics.
+  bool operator()(mask_type set_variables) const
+  {
+    for (auto&& term : m_terms)
+      if (term.evaluate(set_variables))
+        return true;
+    return m_literal_value;
+  }
+
+  // Evaluate and gather statistics.
+  // All terms are tested, so that the hit rate of a term does not depend on the current order.
+  bool profile(mask_type set_variables);
+
+  // Sort the terms by hit rate, most often true first; terms with fewer variables first when the hit rate is equal.
+  void reorder();
+
+  // Forget all statistics.
+  void reset_statistics();
+
+  size_t size() const { return m_terms.size(); }
+  Product const& term(size_t i) const { return m_terms[i]; }
+  uint64_t evaluations() const { return m_evaluations; }
+  double hit_rate(size_t i) const { return m_evaluations == 0 ? 0.0 : static_cast<double>(m_hits[i]) / m_evaluations; }
+};
+
+} // namespace boolean
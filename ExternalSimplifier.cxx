@@ -0,0 +1,534 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief Definition of ExternalSimplifier in namespace boolean.
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "sys.h"
+#include "debug.h"
+#include "ExternalSimplifier.h"
+#include "BitOperations.h"
+#include <algorithm>
+#include <array>
+#include <unordered_set>
+#include <queue>
+#include <memory>
+#include <system_error>
+#include <type_traits>
+#include <cstdio>
+#include <cerrno>
+#include <unistd.h>
+
+namespace boolean {
+
+namespace {
+
+static_assert(std::is_trivially_copyable<Product>::value, "Products are read and written as raw bytes.");
+
+size_t constexpr io_buffer_size = 65536;        // Number of products per read or write.
+
+void throw_system_error(char const* what, std::string const& filename)
+{
+  throw std::system_error(errno, std::generic_category(), std::string(what) + " \"" + filename + "\"");
+}
+
+class ProductReader
+{
+ private:
+  std::string m_filename;
+  std::FILE* m_file;
+  std::vector<Product> m_buffer;
+  size_t m_position;
+  size_t m_count;
+
+ public:
+  ProductReader(std::string const& filename) : m_filename(filename), m_file(std::fopen(filename.c_str(), "rb")), m_buffer(io_buffer_size), m_position(0), m_count(0)
+  {
+    if (!m_file)
+      throw_system_error("Could not open", filename);
+  }
+  ~ProductReader() { std::fclose(m_file); }
+
+  bool next(Product& product)
+  {
+    if (m_position == m_count)
+    {
+      m_count = std::fread(m_buffer.data(), sizeof(Product), m_buffer.size(), m_file);
+      m_position = 0;
+      if (m_count == 0)
+      {
+        if (std::ferror(m_file))
+          throw_system_error("Error reading", m_filename);
+        return false;
+      }
+    }
+    product = m_buffer[m_position++];
+    return true;
+  }
+};
+
+class ProductWriter
+{
+ private:
+  std::string m_filename;
+  std::FILE* m_file;
+  std::vector<Product> m_buffer;
+  size_t m_count;
+
+ public:
+  ProductWriter(std::string const& filename) : m_filename(filename), m_file(std::fopen(filename.c_str(), "wb")), m_count(0)
+  {
+    if (!m_file)
+      throw_system_error("Could not create", filename);
+    m_buffer.reserve(io_buffer_size);
+  }
+  ~ProductWriter() { if (m_file) std::fclose(m_file); }
+
+  void write(Product const& product)
+  {
+    m_buffer.push_back(product);
+    if (m_buffer.size() == io_buffer_size)
+      flush();
+    ++m_count;
+  }
+
+  void flush()
+  {
+    if (std::fwrite(m_buffer.data(), sizeof(Product), m_buffer.size(), m_file) != m_buffer.size())
+      throw_system_error("Error writing", m_filename);
+    m_buffer.clear();
+  }
+
+  void close()
+  {
+    flush();
+    std::FILE* file = m_file;
+    m_file = nullptr;
+    if (std::fclose(file) != 0)
+      throw_system_error("Error closing", m_filename);
+  }
+
+  size_t count() const { return m_count; }
+};
+
+// The terms of a block, indexed by their set of variables. A term includes all of a term of the block iff,
+// for one of the variable sets of the block that is a proper subset of its own, the block has a term with
+// the same negations on that set.
+class SubsumerIndex
+{
+  using mask_type = Product::mask_type;
+
+ private:
+  std::vector<Product> m_table;                 // Open addressing with linear probing; unused slots are zero (never a term).
+  size_t m_table_mask;
+  std::vector<mask_type> m_variable_sets;       // The distinct care masks of the terms, ordered by number of variables.
+  std::array<size_t, 66> m_first_with_size;     // Index into m_variable_sets of the first set with (at least) that many variables.
+
+ public:
+  SubsumerIndex(std::vector<Product> const& terms) : m_table_mask(1)
+  {
+    // Keep the load factor at most 3/4.
+    while (m_table_mask + 1 < terms.size() + terms.size() / 3 + 1)
+      m_table_mask = 2 * m_table_mask + 1;
+    m_table.resize(m_table_mask + 1, Product(false));
+    m_variable_sets.reserve(terms.size());
+    for (auto&& term : terms)
+    {
+      size_t slot = term.hash() & m_table_mask;
+      while (m_table[slot] != Product(false) && m_table[slot] != term)
+        slot = (slot + 1) & m_table_mask;
+      m_table[slot] = term;
+      m_variable_sets.push_back(term.care_mask());
+    }
+    auto by_size = [](mask_type variables1, mask_type variables2){
+      int const size1 = __builtin_popcountll(variables1);
+      int const size2 = __builtin_popcountll(variables2);
+      return size1 < size2 || (size1 == size2 && variables1 < variables2);
+    };
+    std::sort(m_variable_sets.begin(), m_variable_sets.end(), by_size);
+    m_variable_sets.erase(std::unique(m_variable_sets.begin(), m_variable_sets.end()), m_variable_sets.end());
+    size_t index = 0;
+    for (int size = 0; size < 66; ++size)
+    {
+      while (index < m_variable_sets.size() && __builtin_popcountll(m_variable_sets[index]) < size)
+        ++index;
+      m_first_with_size[size] = index;
+    }
+  }
+
+  // Return true if product includes all of a term (with fewer variables) in the index.
+  bool subsumes(Product const& product) const
+  {
+    mask_type const care = product.care_mask();
+    mask_type const value = product.value_mask();
+    int const number_of_variables = __builtin_popcountll(care);
+    size_t const smaller_sets = m_first_with_size[number_of_variables];
+    if (smaller_sets == 0)
+      return false;
+    if (number_of_variables < 32 && (size_t{1} << number_of_variables) < smaller_sets)
+    {
+      // Fewer subsets of the variables of product than smaller variable sets in the index: look up each (non-empty)
+      // proper subset that has a size that occurs in the index.
+      for (mask_type subset = next_subset(0, care); subset != care; subset = next_subset(subset, care))
+      {
+        int const size = __builtin_popcountll(subset);
+        if (m_first_with_size[size] != m_first_with_size[size + 1] && contains(subset, value))
+          return true;
+      }
+    }
+    else
+    {
+      for (size_t index = 0; index < smaller_sets; ++index)
+        if ((m_variable_sets[index] & ~care) == 0 && contains(m_variable_sets[index], value))
+          return true;
+    }
+    return false;
+  }
+
+ private:
+  // Return true if the index has the term with variables variables that are true where they are true in value.
+  bool contains(mask_type variables, mask_type value) const
+  {
+    Product const term(~variables, ~(value & variables));
+    for (size_t slot = term.hash() & m_table_mask; m_table[slot] != Product(false); slot = (slot + 1) & m_table_mask)
+      if (m_table[slot] == term)
+        return true;
+    return false;
+  }
+};
+
+} // namespace
+
+ExternalSimplifier::ExternalSimplifier(std::string const& temporary_directory, size_t memory_budget) :
+  m_temporary_directory(temporary_directory), m_memory_budget(std::max(memory_budget / sizeof(Product), size_t{2})), m_next_temporary(0)
+{
+}
+
+std::string ExternalSimplifier::temporary_filename()
+{
+  return m_temporary_directory + "/boolean-expression-" + std::to_string(getpid()) + '-' + std::to_string(m_next_temporary++) + ".tmp";
+}
+
+//static
+void ExternalSimplifier::write_literal(std::string const& output_filename, bool literal)
+{
+  ProductWriter writer(output_filename);
+  writer.write(Product(literal));
+  writer.close();
+}
+
+void ExternalSimplifier::simplify(std::string const& input_filename, std::string const& output_filename)
+{
+  std::string current = input_filename;
+  bool current_is_temporary = false;
+  for (;;)
+  {
+    std::vector<std::string> runs;
+    bool is_one = generate_runs(current, runs);
+    if (current_is_temporary)
+      std::remove(current.c_str());
+    if (is_one)
+    {
+      for (auto&& run : runs)
+        std::remove(run.c_str());
+      write_literal(output_filename, true);
+      return;
+    }
+    std::string sorted = merge_runs(runs);
+    std::string next = temporary_filename();
+    bool changed;
+    is_one = shorten_and_merge(sorted, next, changed);
+    if (is_one || !changed)
+    {
+      std::remove(next.c_str());
+      if (is_one)
+        write_literal(output_filename, true);
+      else
+        remove_subsumed(sorted, output_filename);
+      std::remove(sorted.c_str());
+      return;
+    }
+    std::remove(sorted.c_str());
+    current = next;
+    current_is_temporary = true;
+  }
+}
+
+// Read chunks of m_memory_budget products, sort each (removing duplicates) and write it as a sorted run.
+// Returns true if the sum is one.
+bool ExternalSimplifier::generate_runs(std::string const& input_filename, std::vector<std::string>& runs)
+{
+  ProductReader reader(input_filename);
+  std::vector<Product> chunk;
+  Product product;
+  bool more = true;
+  while (more)
+  {
+    chunk.clear();
+    while (chunk.size() < m_memory_budget && (more = reader.next(product)))
+    {
+      if (product.is_one())
+        return true;
+      if (!product.is_zero())
+        chunk.push_back(product);
+    }
+    if (chunk.empty())
+      break;
+    // Only sort: the simplification happens while streaming over the merged runs.
+    Expression run;
+    run.m_sum_of_products = std::move(chunk);
+    run.sort_terms();
+    runs.push_back(temporary_filename());
+    ProductWriter writer(runs.back());
+    for (auto&& term : run.products())
+      writer.write(term);
+    writer.close();
+    chunk = std::vector<Product>();
+  }
+  return false;
+}
+
+// Merge the sorted runs into a single sorted file without duplicates. Returns its name.
+std::string ExternalSimplifier::merge_runs(std::vector<std::string>& runs)
+{
+  if (runs.empty())
+  {
+    // An empty sum; create an empty file.
+    runs.push_back(temporary_filename());
+    ProductWriter(runs.back()).close();
+  }
+  while (runs.size() > 1)
+  {
+    std::vector<std::string> merged;
+    for (size_t first = 0; first < runs.size(); first += merge_fan_in)
+    {
+      size_t const last = std::min(first + merge_fan_in, runs.size());
+      std::vector<std::unique_ptr<ProductReader>> readers;
+      struct Head { Product m_product; size_t m_reader; };
+      // The terms are ordered from large to small, so the largest term must be on top.
+      auto compare = [](Head const& head1, Head const& head2){ return Expression::less(head1.m_product, head2.m_product); };
+      std::priority_queue<Head, std::vector<Head>, decltype(compare)> heads(compare);
+      for (size_t r = first; r < last; ++r)
+      {
+        readers.emplace_back(new ProductReader(runs[r]));
+        Head head{Product(false), readers.size() - 1};
+        if (readers.back()->next(head.m_product))
+          heads.push(head);
+      }
+      merged.push_back(temporary_filename());
+      ProductWriter writer(merged.back());
+      bool first_term = true;
+      Product last_written;
+      while (!heads.empty())
+      {
+        Head head = heads.top();
+        heads.pop();
+        if (first_term || head.m_product != last_written)
+        {
+          writer.write(head.m_product);
+          last_written = head.m_product;
+          first_term = false;
+        }
+        if (readers[head.m_reader]->next(head.m_product))
+          heads.push(head);
+      }
+      writer.close();
+      readers.clear();
+      for (size_t r = first; r < last; ++r)
+        std::remove(runs[r].c_str());
+    }
+    runs.swap(merged);
+  }
+  return runs[0];
+}
+
+// Stream over the sorted file, applying the merge rule within groups of terms with the same variables
+// and shortening or removing terms using the single-variable terms. New terms are written unsorted.
+// Returns true if the sum is one.
+bool ExternalSimplifier::shorten_and_merge(std::string const& sorted_filename, std::string const& output_filename, bool& changed)
+{
+  using mask_type = Product::mask_type;
+  changed = false;
+
+  // The single-variable terms are at the end of the sorted file.
+  mask_type single_true = 0;            // Variables X for which the term X exists.
+  mask_type single_false = 0;           // Variables X for which the term X' exists.
+  {
+    std::FILE* file = std::fopen(sorted_filename.c_str(), "rb");
+    if (!file)
+      throw_system_error("Could not open", sorted_filename);
+    // There are at most 2 * max_number_of_variables different single-variable terms.
+    long const tail = 2 * Product::max_number_of_variables;
+    std::fseek(file, 0, SEEK_END);
+    long const size = std::ftell(file) / sizeof(Product);
+    std::fseek(file, std::max(size - tail, 0L) * sizeof(Product), SEEK_SET);
+    Product buffer[2 * Product::max_number_of_variables];
+    size_t const count = std::fread(buffer, sizeof(Product), std::min(size, tail), file);
+    std::fclose(file);
+    for (size_t i = 0; i < count; ++i)
+    {
+      if (buffer[i].number_of_variables() != 1)
+        continue;
+      mask_type const variable = buffer[i].care_mask();
+      if ((buffer[i].negation_mask() & variable))
+        single_false |= variable;
+      else
+        single_true |= variable;
+    }
+    if ((single_true & single_false))   // X + X' = 1.
+      return true;
+  }
+
+  ProductReader reader(sorted_filename);
+  ProductWriter writer(output_filename);
+  std::vector<Product> group;
+  std::unordered_set<mask_type> negations;
+  Product product;
+  bool more = reader.next(product);
+  while (more)
+  {
+    // Read the next group of terms with the same variables.
+    group.clear();
+    mask_type const variables = product.variables_mask();
+    do
+    {
+      group.push_back(product);
+    }
+    while ((more = reader.next(product)) && product.variables_mask() == variables);
+
+    mask_type const used = ~variables;
+    bool const is_single = (used & (used - 1)) == 0;
+    negations.clear();
+    size_t kept = 0;
+    for (auto&& term : group)
+    {
+      mask_type const negated = term.negation_mask() & used;
+      mask_type const not_negated = used & ~negated;
+      if (!is_single)
+      {
+        // ABCX + X = X.
+        if ((not_negated & single_true) || (negated & single_false))
+          continue;                     // Removing a term keeps the file sorted; this is not a change that requires another pass.
+        // ABCX' + X = ABC + X.
+        mask_type const remove = (negated & single_true) | (not_negated & single_false);
+        if (remove)
+        {
+          writer.write(Product(term.variables_mask() | remove, term.negation_mask() | remove));
+          changed = true;
+          continue;
+        }
+      }
+      group[kept++] = term;
+      negations.insert(term.negation_mask());
+    }
+    group.resize(kept);
+
+    // ABC + ABC' = AB.
+    for (auto&& term : group)
+    {
+      bool merged = false;
+      for (mask_type bits = used; bits; bits &= bits - 1)
+      {
+        mask_type const bit = bits & -bits;
+        if (negations.count(term.negation_mask() ^ bit))
+        {
+          merged = true;
+          // Write the common factor only once (from the side where the variable is not negated).
+          if (!(term.negation_mask() & bit))
+          {
+            if (is_single)
+              return true;      // X + X' = 1.
+            writer.write(Product(term.variables_mask() | bit, term.negation_mask() | bit));
+          }
+        }
+      }
+      if (merged)
+        changed = true;
+      else
+        writer.write(term);
+    }
+  }
+  writer.close();
+  return false;
+}
+
+// Remove terms that include all variables (with the same negation) of another term.
+// Each pass indexes one block of terms in memory and streams the file past it.
+void ExternalSimplifier::remove_subsumed(std::string const& sorted_filename, std::string const& output_filename)
+{
+  std::string current = sorted_filename;
+  bool current_is_temporary = false;
+  size_t offset = 0;                    // Index in current of the first term that wasn't part of a block yet.
+  for (;;)
+  {
+    // Read and index the next block. The block and its index together take roughly four times the memory of its terms.
+    std::vector<Product> terms;
+    {
+      ProductReader reader(current);
+      Product product;
+      for (size_t index = 0; terms.size() < std::max(m_memory_budget / 4, size_t{1}) && reader.next(product); ++index)
+        if (index >= offset)
+          terms.push_back(product);
+    }
+    size_t const block_size = terms.size();
+    SubsumerIndex const block(terms);
+    terms = std::vector<Product>();
+    if (block_size == 0)
+      break;
+    // A term can only include all of a term that has fewer variables, which come later in the file.
+    std::string next = temporary_filename();
+    ProductReader reader(current);
+    ProductWriter writer(next);
+    Product product;
+    size_t const block_end = offset + block_size;
+    size_t next_offset = 0;
+    for (size_t index = 0; reader.next(product); ++index)
+    {
+      bool const subsumed = index < block_end && block.subsumes(product);
+      if (!subsumed)
+      {
+        writer.write(product);
+        if (index < block_end)
+          ++next_offset;
+      }
+    }
+    writer.close();
+    if (current_is_temporary)
+      std::remove(current.c_str());
+    current = next;
+    current_is_temporary = true;
+    offset = next_offset;
+  }
+  // Copy the result to the output (an empty sum is zero).
+  ProductReader reader(current);
+  ProductWriter writer(output_filename);
+  Product product;
+  while (reader.next(product))
+    writer.write(product);
+  if (writer.count() == 0)
+    writer.write(Product(false));
+  writer.close();
+  if (current_is_temporary)
+    std::remove(current.c_str());
+}
+
+} // namespace boolean
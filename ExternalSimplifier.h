@@ -0,0 +1,87 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief Definition of ExternalSimplifier in namespace boolean.
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+// Usage:
+//
+// Simplify a sum of products that is too large to fit in memory.
+// Input and output are files of serialized products: a sequence of
+// records, each the raw (host byte order) m_variables and m_negation
+// of one Product. The input terms may be in any order and may include
+// duplicates and literals. The output contains the terms of the
+// simplified Expression in Expression order (a single literal record
+// if the result is zero or one).
+//
+// ExternalSimplifier simplifier("/var/tmp", 1 << 30);  // Use at most about 1 GB of memory for terms.
+// simplifier.simplify("products.bin", "simplified.bin");
+//
+// The algorithm:
+// 1. Sort: chunks that fit in memory are sorted and written as sorted runs, which are then merged
+//    (with deduplication) into one sorted file.
+// 2. Stream over the sorted file, where terms with the same variables are adjacent. Apply the merge rule
+//    (ABC + ABC' = AB) within each such group, and remove or shorten terms using the single-variable terms
+//    (ABC' + C = AB + C), which are at the end of the file. If anything changed, repeat from 1.
+// 3. Remove terms that include all of a term with fewer variables (ABC + AB = AB), in passes that each
+//    hold one block of terms in memory, indexed by variable set, and stream the rest of the file past it.
+//    Testing a term with k variables takes at most min(2^k, number of smaller variable sets in the block) lookups.
+//
+// All terms with the same set of variables must fit in memory at once.
+// I/O errors are reported by throwing std::system_error.
+
+#pragma once
+
+#include "BooleanExpression.h"
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace boolean {
+
+class ExternalSimplifier
+{
+ public:
+  static constexpr size_t merge_fan_in = 64;            // The maximum number of runs that are merged at once.
+
+ private:
+  std::string m_temporary_directory;                    // Where to store temporary files.
+  size_t m_memory_budget;                               // The maximum number of terms to hold in memory.
+  unsigned int m_next_temporary;                        // Used to generate unique temporary file names.
+
+ public:
+  // Temporary files are created in temporary_directory; memory_budget is in bytes.
+  ExternalSimplifier(std::string const& temporary_directory, size_t memory_budget);
+
+  // Read the products in input_filename and write their simplified sum to output_filename.
+  void simplify(std::string const& input_filename, std::string const& output_filename);
+
+ private:
+  std::string temporary_filename();
+  bool generate_runs(std::string const& input_filename, std::vector<std::string>& runs);
+  std::string merge_runs(std::vector<std::string>& runs);
+  bool shorten_and_merge(std::string const& sorted_filename, std::string const& output_filename, bool& changed);
+  void remove_subsumed(std::string const& sorted_filename, std::string const& output_filename);
+  static void write_literal(std::string const& output_filename, bool literal);
+};
+
+} // namespace boolean
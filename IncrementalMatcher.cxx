@@ -0,0 +1,174 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief Definition of IncrementalMatcher in namespace boolean.
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "sys.h"
+#include "debug.h"
+#include "IncrementalMatcher.h"
+#include "BitOperations.h"
+
+namespace boolean {
+
+size_t IncrementalMatcher::add(Expression const& expression)
+{
+  ASSERT(expression.is_initialized());
+  uint32_t const index = m_expressions.size();
+  m_expressions.push_back({ 0, 0, false });
+  ExpressionState& state = m_expressions.back();
+  if (expression.is_literal())
+  {
+    // A literal one is represented by a single term without literals, that is always true.
+    if (expression.is_one())
+    {
+      m_terms.push_back({ index, 0, 0 });
+      state.m_true_terms = 1;
+    }
+  }
+  else
+  {
+    for (auto&& product : expression.products())
+    {
+      uint32_t const term = m_terms.size();
+      mask_type const used = product.care_mask();
+      uint8_t const number_of_literals = __builtin_popcountll(used);
+      uint8_t const satisfied = __builtin_popcountll(used & (m_values ^ product.negation_mask()));
+      m_terms.push_back({ index, number_of_literals, satisfied });
+      for (Variable::id_type id : SetBits(used))
+        m_watches[id].push_back({ term, ((product.negation_mask() >> id) & 1) != 0 });
+      if (satisfied == number_of_literals)
+        ++state.m_true_terms;
+    }
+  }
+  if (state.m_true_terms > 0)
+  {
+    state.m_position = m_true_expressions.size();
+    m_true_expressions.push_back(index);
+  }
+  return index;
+}
+
+void IncrementalMatcher::reset(mask_type values)
+{
+  m_values = values;
+  for (auto&& term : m_terms)
+    term.m_satisfied = 0;
+  for (Variable::id_type id = 0; id < Product::max_number_of_variables; ++id)
+  {
+    bool value = is_set(id);
+    for (auto&& watch : m_watches[id])
+      if (value != watch.m_negated)
+        ++m_terms[watch.m_term].m_satisfied;
+  }
+  std::vector<bool> was_true(m_expressions.size());
+  for (uint32_t expression = 0; expression < m_expressions.size(); ++expression)
+  {
+    was_true[expression] = m_expressions[expression].m_true_terms > 0;
+    m_expressions[expression].m_true_terms = 0;
+  }
+  for (auto&& term : m_terms)
+    if (term.m_satisfied == term.m_number_of_literals)
+      ++m_expressions[term.m_expression].m_true_terms;
+  m_true_expressions.clear();
+  for (uint32_t expression = 0; expression < m_expressions.size(); ++expression)
+  {
+    ExpressionState& state = m_expressions[expression];
+    if (state.m_true_terms > 0)
+    {
+      state.m_position = m_true_expressions.size();
+      m_true_expressions.push_back(expression);
+    }
+    if ((state.m_true_terms > 0) != was_true[expression])
+      mark_changed(expression);
+  }
+}
+
+void IncrementalMatcher::assign(mask_type values)
+{
+  for (mask_type different = (m_values ^ values) & Product::all_variables; different; different &= different - 1)
+    flip(__builtin_ctzll(different));
+}
+
+void IncrementalMatcher::flip(Variable::id_type id)
+{
+  ASSERT(id < Product::max_number_of_variables);
+  m_values ^= mask_type{1} << id;
+  bool const value = is_set(id);
+  for (auto&& watch : m_watches[id])
+  {
+    TermState& term = m_terms[watch.m_term];
+    if (value != watch.m_negated)
+    {
+      // The literal became satisfied.
+      if (++term.m_satisfied == term.m_number_of_literals)
+        term_became_true(term);
+    }
+    else if (term.m_satisfied-- == term.m_number_of_literals)
+      term_became_false(term);
+  }
+}
+
+void IncrementalMatcher::term_became_true(TermState const& term)
+{
+  ExpressionState& state = m_expressions[term.m_expression];
+  if (state.m_true_terms++ == 0)
+  {
+    state.m_position = m_true_expressions.size();
+    m_true_expressions.push_back(term.m_expression);
+    mark_changed(term.m_expression);
+  }
+}
+
+void IncrementalMatcher::term_became_false(TermState const& term)
+{
+  ExpressionState& state = m_expressions[term.m_expression];
+  ASSERT(state.m_true_terms > 0);
+  if (--state.m_true_terms == 0)
+  {
+    // Remove the expression from m_true_expressions by moving the last element into its place.
+    uint32_t const last = m_true_expressions.back();
+    m_true_expressions[state.m_position] = last;
+    m_expressions[last].m_position = state.m_position;
+    m_true_expressions.pop_back();
+    mark_changed(term.m_expression);
+  }
+}
+
+void IncrementalMatcher::mark_changed(uint32_t expression)
+{
+  ExpressionState& state = m_expressions[expression];
+  if (!state.m_changed)
+  {
+    state.m_changed = true;
+    m_changed.push_back(expression);
+  }
+}
+
+void IncrementalMatcher::clear_changed()
+{
+  for (uint32_t expression : m_changed)
+    m_expressions[expression].m_changed = false;
+  m_changed.clear();
+}
+
+} // namespace boolean
@@ -0,0 +1,122 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief Definition of IncrementalMatcher in namespace boolean.
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+// Usage:
+//
+// An IncrementalMatcher keeps track of which of a set of Expressions are true
+// for an assignment of all variables that changes a few variables at a time.
+//
+// IncrementalMatcher matcher;
+// size_t rule1 = matcher.add(A * B + !C);
+// size_t rule2 = matcher.add(...);
+// matcher.reset(values);       // Bit id of values is the value of the variable with that id.
+// matcher.set(B, false);       // Only visits the terms that contain B or !B.
+// if (matcher.is_true(rule1))
+//   ...
+//
+// The cost of set() is proportional to the number of terms that contain the variable.
+// Each term keeps a count of how many of its literals are currently satisfied;
+// the term is true when all of them are.
+
+#pragma once
+
+#include "BooleanExpression.h"
+#include <vector>
+#include <cstdint>
+
+namespace boolean {
+
+class IncrementalMatcher
+{
+ public:
+  using mask_type = Product::mask_type;
+
+ private:
+  struct TermState
+  {
+    uint32_t m_expression;              // Index of the Expression that this term belongs to.
+    uint8_t m_number_of_literals;       // The number of variables in the term.
+    uint8_t m_satisfied;                // The number of those variables that currently have the right value.
+  };
+
+  struct Watch
+  {
+    uint32_t m_term;                    // Index into m_terms.
+    bool m_negated;                     // True if the variable occurs negated in the term.
+  };
+
+  struct ExpressionState
+  {
+    uint32_t m_true_terms;              // The number of terms of this Expression that are currently true.
+    uint32_t m_position;                // Index into m_true_expressions when m_true_terms > 0.
+    bool m_changed;                     // Set when the Expression is in m_changed.
+  };
+
+  std::vector<TermState> m_terms;
+  std::vector<Watch> m_watches[Product::max_number_of_variables];       // Per variable, the terms that contain it.
+  std::vector<ExpressionState> m_expressions;
+  std::vector<uint32_t> m_true_expressions;                             // The indices of all Expressions that are currently true (unordered).
+  std::vector<uint32_t> m_changed;                                      // Expressions whose value changed since the last call to clear_changed().
+  mask_type m_values;                                                   // The current assignment.
+
+ public:
+  IncrementalMatcher() : m_values(Product::empty_mask) { }
+
+  // Add an Expression; returns its index. The Expression is evaluated for the current assignment.
+  size_t add(Expression const& expression);
+
+  // Set all variables at once; bit id of values is the new value of the variable with that id.
+  // This costs as much as evaluating all Expressions from scratch.
+  void reset(mask_type values);
+
+  // Change the values of only those variables that are different in values.
+  void assign(mask_type values);
+
+  // Change the value of a single variable.
+  void set(Variable variable, bool value) { if (value != is_set(variable.m_id)) flip(variable.m_id); }
+
+  // Toggle the value of the variable with id.
+  void flip(Variable::id_type id);
+
+  bool is_true(size_t expression) const { return m_expressions[expression].m_true_terms > 0; }
+  size_t size() const { return m_expressions.size(); }
+  mask_type values() const { return m_values; }
+
+  // The indices of all Expressions that are currently true, in no particular order.
+  std::vector<uint32_t> const& true_expressions() const { return m_true_expressions; }
+
+  // The indices of all Expressions whose value changed since the last call to clear_changed().
+  // An Expression that changed back to its old value is still listed; use is_true() to get the current value.
+  std::vector<uint32_t> const& changed() const { return m_changed; }
+  void clear_changed();
+
+ private:
+  bool is_set(Variable::id_type id) const { return (m_values >> id) & 1; }
+  void term_became_true(TermState const& term);
+  void term_became_false(TermState const& term);
+  void mark_changed(uint32_t expression);
+};
+
+} // namespace boolean
@@ -0,0 +1,136 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief Definition of TimesGenerator and InverseGenerator in namespace boolean.
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "sys.h"
+#include "debug.h"
+#include "ProductGenerator.h"
+
+namespace boolean {
+
+TimesGenerator::TimesGenerator(Expression const& expression1, Expression const& expression2) :
+  m_expression1(expression1), m_expression2(expression2), m_term1(0), m_term2(0)
+{
+  ASSERT(expression1.is_initialized() && expression2.is_initialized());
+  // Zero times anything is zero: generate nothing.
+  if (expression1.is_zero() || expression2.is_zero())
+    m_term1 = expression1.products().size();
+}
+
+bool TimesGenerator::next(Product& product)
+{
+  Span<Product const> const terms1 = m_expression1.products();
+  Span<Product const> const terms2 = m_expression2.products();
+  while (m_term1 < terms1.size())
+  {
+    Product const& term1(terms1[m_term1]);
+    Product const& term2(terms2[m_term2]);
+    if (++m_term2 == terms2.size())
+    {
+      m_term2 = 0;
+      ++m_term1;
+    }
+    product = term1 * term2;
+    if (!product.is_zero())
+      return true;
+  }
+  return false;
+}
+
+InverseGenerator::InverseGenerator(Expression const& expression) : m_depth(0)
+{
+  ASSERT(expression.is_initialized());
+  if (expression.is_one())
+  {
+    m_depth = -1;               // The inverse is zero: generate nothing.
+    return;
+  }
+  // The inverse of zero is one: a single level with the single choice one.
+  if (expression.is_zero())
+    m_literals.emplace_back(1, Product(true));
+  else
+  {
+    for (auto&& term : expression.products())
+    {
+      m_literals.emplace_back();
+      for (Product::mask_type used = term.care_mask(); used; used &= used - 1)
+      {
+        Product::mask_type const bit = used & -used;
+        // The inverse of a variable in term: negated if it isn't negated in term and vice versa.
+        m_literals.back().emplace_back(~bit, (term.negation_mask() & bit) ? ~bit : Product::full_mask);
+      }
+    }
+  }
+  m_partial.resize(m_literals.size() + 1);
+  m_partial[0] = true;
+  m_choice.resize(m_literals.size(), 0);
+}
+
+bool InverseGenerator::next(Product& product)
+{
+  int const number_of_levels = m_literals.size();
+  while (m_depth >= 0)
+  {
+    if (m_depth == number_of_levels)
+    {
+      product = m_partial[number_of_levels];
+      --m_depth;                // Continue with the next choice of the last level.
+      return true;
+    }
+    std::vector<Product> const& literals(m_literals[m_depth]);
+    size_t& choice(m_choice[m_depth]);
+    Product const& partial(m_partial[m_depth]);
+    if (choice == 0)
+    {
+      // If one of the literals of this level is already part of partial then every other choice
+      // results in a product that is absorbed by partial itself; only take that literal.
+      bool absorbed = false;
+      for (auto&& literal : literals)
+        if (partial * literal == partial)
+        {
+          absorbed = true;
+          break;
+        }
+      if (absorbed)
+      {
+        choice = literals.size();               // Backtrack when we get back here.
+        m_partial[++m_depth] = partial;
+        continue;
+      }
+    }
+    if (choice == literals.size())
+    {
+      // All choices of this level were tried. Levels are only left this way, so m_choice is zero for every level below m_depth.
+      choice = 0;
+      --m_depth;
+      continue;
+    }
+    Product next_partial = partial * literals[choice++];
+    if (!next_partial.is_zero())
+      m_partial[++m_depth] = next_partial;
+  }
+  return false;
+}
+
+} // namespace boolean
@@ -0,0 +1,146 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief Definition of TimesGenerator, InverseGenerator and Deduplicated in namespace boolean.
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+// Usage:
+//
+// Generators produce the terms of a.times(b) or e.inverse() one at a time,
+// without simplifying them and without storing the result. The sum of all
+// generated terms is equivalent to the result of the operation (no terms
+// at all means zero). The consumer can stop at any time.
+//
+// TimesGenerator generator(a, b);
+// Product term;
+// while (generator.next(term))
+//   ...
+//
+// // Or, skipping most duplicates using a fixed amount of memory:
+// for (Product const& term : Deduplicated<InverseGenerator>(e))
+//   ...
+//
+// The generators keep references to the expressions that they were
+// constructed with; those must stay alive and unchanged while generating.
+
+#pragma once
+
+#include "BooleanExpression.h"
+#include <vector>
+#include <utility>
+
+namespace boolean {
+
+// Input iterator over the terms of a generator (any class with a member bool next(Product&)).
+template<class Generator>
+class GeneratorIterator
+{
+ private:
+  Generator* m_generator;       // nullptr for the end iterator.
+  Product m_product;
+
+ public:
+  GeneratorIterator() : m_generator(nullptr) { }
+  explicit GeneratorIterator(Generator& generator) : m_generator(&generator) { ++*this; }
+
+  Product const& operator*() const { return m_product; }
+  Product const* operator->() const { return &m_product; }
+  GeneratorIterator& operator++() { if (!m_generator->next(m_product)) m_generator = nullptr; return *this; }
+
+  friend bool operator==(GeneratorIterator const& iter1, GeneratorIterator const& iter2) { return iter1.m_generator == iter2.m_generator; }
+  friend bool operator!=(GeneratorIterator const& iter1, GeneratorIterator const& iter2) { return iter1.m_generator != iter2.m_generator; }
+};
+
+// Generates the non-zero products term1 * term2 of all pairs of terms of two Expressions.
+class TimesGenerator
+{
+ private:
+  Expression const& m_expression1;
+  Expression const& m_expression2;
+  size_t m_term1;               // Index of the next term of m_expression1 to use.
+  size_t m_term2;               // Index of the next term of m_expression2 to use.
+
+ public:
+  TimesGenerator(Expression const& expression1, Expression const& expression2);
+
+  bool next(Product& product);
+
+  GeneratorIterator<TimesGenerator> begin() { return GeneratorIterator<TimesGenerator>(*this); }
+  GeneratorIterator<TimesGenerator> end() { return {}; }
+};
+
+// Generates the terms of the inverse of an Expression.
+//
+// The inverse of a sum of products is the product of the inverses of its terms,
+// each of which is a sum of single (negated) variables; every term generated is
+// the product of one such variable of each term. This is a depth first search
+// that skips choices that result in zero and choices that are absorbed by a
+// variable that was already chosen.
+class InverseGenerator
+{
+ private:
+  std::vector<std::vector<Product>> m_literals; // For each term of the Expression, the inverse of each of its variables.
+  std::vector<Product> m_partial;               // m_partial[k] is the product of the choices at levels 0 .. k - 1.
+  std::vector<size_t> m_choice;                 // m_choice[k] is the index of the next literal to try at level k.
+  int m_depth;                                  // The level that is currently being chosen, or -1 when done.
+
+ public:
+  InverseGenerator(Expression const& expression);
+
+  bool next(Product& product);
+
+  GeneratorIterator<InverseGenerator> begin() { return GeneratorIterator<InverseGenerator>(*this); }
+  GeneratorIterator<InverseGenerator> end() { return {}; }
+};
+
+// Wraps another generator and skips terms that are equal to one of the recently generated terms.
+// Uses a direct mapped cache of 2^log2_cache_size terms.
+template<class Generator, int log2_cache_size = 12>
+class Deduplicated
+{
+ private:
+  Generator m_generator;
+  std::vector<Product> m_cache;
+
+ public:
+  template<typename... Args>
+  Deduplicated(Args&&... args) : m_generator(std::forward<Args>(args)...), m_cache(size_t{1} << log2_cache_size, Product(false)) { }
+
+  bool next(Product& product)
+  {
+    while (m_generator.next(product))
+    {
+      Product& slot = m_cache[std::hash<Product>()(product) & (m_cache.size() - 1)];
+      if (slot != product)
+      {
+        slot = product;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  GeneratorIterator<Deduplicated> begin() { return GeneratorIterator<Deduplicated>(*this); }
+  GeneratorIterator<Deduplicated> end() { return {}; }
+};
+
+} // namespace boolean
@@ -0,0 +1,99 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief Definition of RuleTable in namespace boolean.
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "sys.h"
+#include "debug.h"
+#include "RuleTable.h"
+#include <algorithm>
+
+namespace boolean {
+
+size_t RuleTable::add(Expression const& expression)
+{
+  ASSERT(expression.is_initialized());
+  if (expression.is_literal())
+  {
+    // One is a term without variables (always true); zero has no terms.
+    if (expression.is_one())
+      m_terms.push_back({ 0, 0 });
+  }
+  else
+  {
+    for (auto&& term : expression.products())
+      m_terms.push_back({ term.care_mask(), term.value_mask() });
+  }
+  m_offsets.push_back(m_terms.size());
+  return m_offsets.size() - 2;
+}
+
+void RuleTable::evaluate(mask_type const* assignments, size_t number_of_assignments, std::vector<word_type>& result) const
+{
+  size_t const words_per_expression = words(number_of_assignments);
+  result.assign(size() * words_per_expression, 0);
+  size_t const terms_per_block = block_size / sizeof(Term);
+  Term const* const terms = m_terms.data();
+  size_t const number_of_terms = m_terms.size();
+
+  size_t expression_begin = 0;
+  while (expression_begin < size())
+  {
+    // Collect whole Expressions into a block of at most terms_per_block terms (but at least one Expression).
+    size_t expression_end = expression_begin + 1;
+    while (expression_end < size() && m_offsets[expression_end + 1] - m_offsets[expression_begin] <= terms_per_block)
+      ++expression_end;
+
+    // Run all assignments over this block, 64 at a time.
+    for (size_t w = 0; w < words_per_expression; ++w)
+    {
+      size_t const first = w * assignments_per_word;
+      size_t const count = std::min(assignments_per_word, number_of_assignments - first);
+      mask_type chunk[assignments_per_word];
+      std::copy(assignments + first, assignments + first + count, chunk);
+      word_type const all_true = count == assignments_per_word ? ~word_type{0} : (word_type{1} << count) - 1;
+
+      for (size_t expression = expression_begin; expression < expression_end; ++expression)
+      {
+        word_type bits = 0;
+        uint32_t const end = m_offsets[expression + 1];
+        for (uint32_t t = m_offsets[expression]; t < end; ++t)
+        {
+          if (t + prefetch_distance < number_of_terms)     // Don't form a pointer past the end of m_terms.
+            __builtin_prefetch(terms + t + prefetch_distance);
+          mask_type const care = terms[t].m_care;
+          mask_type const value = terms[t].m_value;
+          // Test this term against all assignments of the chunk while it is in a register.
+          for (size_t a = 0; a < count; ++a)
+            bits |= word_type{(chunk[a] & care) == value} << a;
+          if (bits == all_true)         // Nothing left to find.
+            break;
+        }
+        result[expression * words_per_expression + w] = bits;
+      }
+    }
+    expression_begin = expression_end;
+  }
+}
+
+} // namespace boolean
@@ -0,0 +1,89 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief Definition of RuleTable in namespace boolean.
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+// Usage:
+//
+// A RuleTable stores the terms of many Expressions in a single contiguous
+// array, so that evaluating all of them streams through memory instead of
+// chasing one heap allocation per Expression.
+//
+// RuleTable table;
+// for (auto&& rule : rules)
+//   table.add(rule);
+// std::vector<RuleTable::word_type> result;
+// table.evaluate(assignments, number_of_assignments, result);
+// // Bit a % 64 of result[rule * table.words(number_of_assignments) + a / 64]
+// // is the value of rule for assignments[a].
+//
+// The evaluation is blocked: a block of terms that fits in the L2 cache is
+// tested against all assignments, 64 assignments per term load, before
+// moving on to the next block.
+
+#pragma once
+
+#include "BooleanExpression.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace boolean {
+
+class RuleTable
+{
+ public:
+  using mask_type = Product::mask_type;
+  using word_type = uint64_t;
+  static constexpr size_t assignments_per_word = 64;
+  static constexpr size_t block_size = 256 * 1024;      // Number of bytes of terms evaluated per block (about the size of the L2 cache).
+  static constexpr size_t prefetch_distance = 8;        // Number of terms to prefetch ahead.
+
+ private:
+  // A term is true when (assignment & m_care) == m_value.
+  struct Term
+  {
+    mask_type m_care;
+    mask_type m_value;
+  };
+
+  std::vector<Term> m_terms;            // The terms of all Expressions.
+  std::vector<uint32_t> m_offsets;      // The terms of Expression i are m_terms[m_offsets[i] .. m_offsets[i + 1] - 1].
+
+ public:
+  RuleTable() : m_offsets(1, 0) { }
+
+  // Append expression; returns its index.
+  size_t add(Expression const& expression);
+
+  // The number of result words per Expression for number_of_assignments assignments.
+  static size_t words(size_t number_of_assignments) { return (number_of_assignments + assignments_per_word - 1) / assignments_per_word; }
+
+  // Evaluate all Expressions for all assignments (bit id of an assignment is the value of the variable with that id).
+  void evaluate(mask_type const* assignments, size_t number_of_assignments, std::vector<word_type>& result) const;
+
+  size_t size() const { return m_offsets.size() - 1; }
+  size_t number_of_terms() const { return m_terms.size(); }
+};
+
+} // namespace boolean
@@ -0,0 +1,179 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief Definition of Sensitivity in namespace boolean.
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "sys.h"
+#include "debug.h"
+#include "Sensitivity.h"
+#include "BitOperations.h"
+#include "CpuFeatures.h"
+#include "TruthProduct.h"
+
+namespace boolean {
+
+namespace {
+
+using mask_type = Product::mask_type;
+int constexpr max_variables = Product::max_number_of_variables;
+
+// Add to count[id], for every variable id in support, the number of the 64 assignments in columns (the value of variable id
+// is columns[id]) for which flipping that variable changes the value of the sum of terms. Only the assignments whose bit is
+// set in valid are counted.
+__attribute__((always_inline)) inline
+void accumulate(Span<Product const> terms, mask_type support, uint64_t const* columns, uint64_t valid, uint64_t* count)
+{
+  // For each variable: the terms without it (independent), and the terms with it, without it, that are
+  // true when it is true (positive), respectively false (negative).
+  uint64_t independent[max_variables] = {};
+  uint64_t positive[max_variables] = {};
+  uint64_t negative[max_variables] = {};
+  for (Product const& term : terms)
+  {
+    mask_type const care = term.care_mask();
+    mask_type const value = term.value_mask();
+    Variable::id_type ids[max_variables];
+    uint64_t prefix[max_variables + 1];         // prefix[k] is the AND of the first k literals.
+    int n = 0;
+    prefix[0] = ~uint64_t{0};
+    for (Variable::id_type id : SetBits(care))
+    {
+      uint64_t const literal = (value & (mask_type{1} << id)) ? columns[id] : ~columns[id];
+      ids[n] = id;
+      prefix[n + 1] = prefix[n] & literal;
+      ++n;
+    }
+    for (Variable::id_type id : SetBits(support & ~care))
+      independent[id] |= prefix[n];
+    // Walk back, maintaining the AND of the literals after k.
+    uint64_t suffix = ~uint64_t{0};
+    for (int k = n - 1; k >= 0; --k)
+    {
+      Variable::id_type const id = ids[k];
+      uint64_t const rest = prefix[k] & suffix;
+      bool const positive_literal = value & (mask_type{1} << id);
+      if (positive_literal)
+        positive[id] |= rest;
+      else
+        negative[id] |= rest;
+      suffix &= positive_literal ? columns[id] : ~columns[id];
+    }
+  }
+  for (Variable::id_type id : SetBits(support))
+    count[id] += __builtin_popcountll(((independent[id] | positive[id]) ^ (independent[id] | negative[id])) & valid);
+}
+
+void accumulate_generic(Span<Product const> terms, mask_type support, uint64_t const* columns, uint64_t valid, uint64_t* count)
+{
+  accumulate(terms, support, columns, valid, count);
+}
+
+#ifdef BOOLEAN_EXPRESSION_X86
+__attribute__((target("popcnt")))
+void accumulate_popcnt(Span<Product const> terms, mask_type support, uint64_t const* columns, uint64_t valid, uint64_t* count)
+{
+  accumulate(terms, support, columns, valid, count);
+}
+#endif
+
+} // namespace
+
+//static
+Product::mask_type Sensitivity::support(Expression const& expression)
+{
+  mask_type result = 0;
+  if (!expression.is_literal())
+    for (Product const& term : expression.products())
+      result |= term.care_mask();
+  return result;
+}
+
+//static
+Expression Sensitivity::boolean_difference(Expression const& expression, Variable variable)
+{
+  Expression const cofactor1 = expression(TruthProduct(Product(variable)));
+  Expression const cofactor0 = expression(TruthProduct(Product(variable, true)));
+  return cofactor1.times(cofactor0.inverse()) + cofactor0.times(cofactor1.inverse());
+}
+
+//static
+std::vector<Sensitivity::Influence> Sensitivity::influence(Expression const& expression, size_t number_of_samples, uint64_t seed)
+{
+  using kernel_type = void (*)(Span<Product const>, mask_type, uint64_t const*, uint64_t, uint64_t*);
+#ifdef BOOLEAN_EXPRESSION_X86
+  static kernel_type const kernel = CpuFeatures::instance().has(CpuFeatures::popcnt) ? accumulate_popcnt : accumulate_generic;
+#else
+  static kernel_type const kernel = accumulate_generic;
+#endif
+  std::vector<Influence> result;
+  // The terms of a literal are not made of variables (zero has all bits of its care mask set).
+  if (expression.is_literal())
+    return result;
+  mask_type const variables = support(expression);
+  int const number_of_variables = __builtin_popcountll(variables);
+  Span<Product const> const terms = expression.products();
+  uint64_t count[max_variables] = {};
+  uint64_t columns[max_variables] = {};
+  uint64_t number_of_assignments;
+  if (number_of_variables <= max_exhaustive_variables)
+  {
+    // Enumerate all assignments of the support: the k-th variable of the support has the value of bit k of the assignment index.
+    number_of_assignments = uint64_t{1} << number_of_variables;
+    uint64_t const valid = number_of_assignments >= 64 ? ~uint64_t{0} : (uint64_t{1} << number_of_assignments) - 1;
+    for (uint64_t block = 0; block < (number_of_assignments + 63) / 64; ++block)
+    {
+      int k = 0;
+      for (Variable::id_type id : SetBits(variables))
+      {
+        if (k < 6)
+        {
+          static uint64_t constexpr patterns[6] = {
+            0xAAAAAAAAAAAAAAAA, 0xCCCCCCCCCCCCCCCC, 0xF0F0F0F0F0F0F0F0, 0xFF00FF00FF00FF00, 0xFFFF0000FFFF0000, 0xFFFFFFFF00000000
+          };
+          columns[id] = patterns[k];
+        }
+        else
+          columns[id] = ((block >> (k - 6)) & 1) ? ~uint64_t{0} : 0;
+        ++k;
+      }
+      kernel(terms, variables, columns, valid, count);
+    }
+  }
+  else
+  {
+    uint64_t state = seed;
+    size_t const number_of_blocks = (number_of_samples + 63) / 64;
+    number_of_assignments = number_of_blocks * 64;
+    for (size_t block = 0; block < number_of_blocks; ++block)
+    {
+      for (Variable::id_type id : SetBits(variables))
+        columns[id] = next_random(state);
+      kernel(terms, variables, columns, ~uint64_t{0}, count);
+    }
+  }
+  for (Variable::id_type id : SetBits(variables))
+    result.push_back({ id, count[id], static_cast<double>(count[id]) / number_of_assignments });
+  return result;
+}
+
+} // namespace boolean
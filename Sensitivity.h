@@ -0,0 +1,77 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief Definition of Sensitivity in namespace boolean.
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+// Usage:
+//
+// How much each variable affects an Expression.
+//
+// The boolean difference of e with respect to x is e|x=1 XOR e|x=0: it is
+// true for the assignments of the other variables for which the value of e
+// depends on x. The influence of x is the fraction of all assignments for
+// which flipping x changes e.
+//
+// Expression d = Sensitivity::boolean_difference(e, x);
+//
+// for (auto&& influence : Sensitivity::influence(e))   // One entry per variable in the support of e.
+//   std::cout << Context::instance()(influence.m_id) << ": " << influence.m_influence << '\n';
+//
+// influence() computes both cofactors of e for all variables at once, 64
+// assignments at a time: per term the AND of all literals but one is shared
+// between its variables (prefix and suffix products). When the support of e
+// has at most max_exhaustive_variables variables all assignments are counted
+// and the result is exact; otherwise number_of_samples random assignments
+// are used.
+
+#pragma once
+
+#include "BooleanExpression.h"
+#include <cstdint>
+#include <vector>
+
+namespace boolean {
+
+class Sensitivity
+{
+ public:
+  static constexpr int max_exhaustive_variables = 20;
+
+  struct Influence
+  {
+    Variable::id_type m_id;
+    uint64_t m_count;           // The number of counted assignments for which flipping the variable changes the Expression.
+    double m_influence;         // m_count divided by the number of counted assignments.
+  };
+
+  // Return e|x=1 XOR e|x=0.
+  static Expression boolean_difference(Expression const& expression, Variable variable);
+
+  // Return the influence of each variable in the support of expression, ordered by id (none for a literal).
+  static std::vector<Influence> influence(Expression const& expression, size_t number_of_samples = 1 << 16, uint64_t seed = 0x696e666c);
+
+  // Return the variables that occur in expression.
+  static Product::mask_type support(Expression const& expression);
+};
+
+} // namespace boolean
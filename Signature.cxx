@@ -0,0 +1,61 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief Definition of Signature in namespace boolean.
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "sys.h"
+#include "debug.h"
+#include "Signature.h"
+#include "BitOperations.h"
+
+namespace boolean {
+
+namespace {
+
+struct Columns
+{
+  Signature::words_type m_column[Signature::number_of_columns];
+
+  constexpr Columns() : m_column{}
+  {
+    // The assignments must be the same for every run of the program (and every program),
+    // so that signatures can be compared and stored.
+    uint64_t state = 0x626F6F6C65616E;                  // "boolean"
+    for (size_t id = 0; id < Signature::number_of_columns; ++id)
+      for (size_t w = 0; w < Signature::number_of_words; ++w)
+        m_column[id][w] = next_random(state);
+  }
+};
+
+constexpr Columns s_columns;
+
+} // namespace
+
+//static
+Signature::words_type const& Signature::column(unsigned int id)
+{
+  ASSERT(id < number_of_columns);
+  return s_columns.m_column[id];
+}
+
+} // namespace boolean
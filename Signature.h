@@ -0,0 +1,118 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief Definition of Signature in namespace boolean.
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+// Usage:
+//
+// A Signature is the truth value of an Expression under a fixed set of
+// number_of_assignments pseudo-random assignments of all variables.
+// Assignment k gives variable id the value of bit k of column(id).
+//
+// Two Expressions with a different Signature can not be equivalent.
+// If the Signatures are equal then the Expressions are likely, but not
+// necessarily, equivalent; use Expression::equivalent to be sure.
+//
+// Expression e1 = ..., e2 = ...;
+// if (e1.signature() != e2.signature())
+//   ; // Not equivalent.
+//
+// Because a Signature only depends on the boolean function that an
+// Expression represents, it can also be used as key in a hash table
+// in order to bucket candidate-equivalent expressions:
+//
+// std::unordered_multimap<Signature, Expression> buckets;
+// buckets.emplace(e1.signature(), std::move(e1));
+//
+// Expression::signature() calculates the Signature every time it is called
+// (in time linear in the number of literals).
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+
+namespace boolean {
+
+class Signature
+{
+ public:
+  using word_type = uint64_t;
+  static constexpr size_t word_size = sizeof(word_type) * 8;            // Size of word_type in bits.
+  static constexpr size_t number_of_assignments = 256;                  // The number of pseudo-random assignments; a multiple of word_size.
+  static constexpr size_t number_of_words = number_of_assignments / word_size;
+  static constexpr size_t number_of_columns = 64;                       // One column per variable id.
+  using words_type = std::array<word_type, number_of_words>;
+
+  static_assert(number_of_assignments % word_size == 0 && 64 <= number_of_assignments && number_of_assignments <= 512,
+      "number_of_assignments must be a multiple of 64 in the range [64, 512].");
+
+ private:
+  words_type m_words;           // Bit k of the whole array is the value of the Expression under assignment k.
+
+ public:
+  // Construct an uninitialized Signature.
+  Signature() { }
+
+  // Construct the Signature of a literal.
+  Signature(bool literal) { m_words.fill(literal ? ~word_type{0} : word_type{0}); }
+
+  // Return the values of variable id under all assignments.
+  static words_type const& column(unsigned int id);
+
+  words_type const& words() const { return m_words; }
+  words_type& words() { return m_words; }
+
+  Signature& operator|=(Signature const& signature)
+  {
+    for (size_t w = 0; w < number_of_words; ++w)
+      m_words[w] |= signature.m_words[w];
+    return *this;
+  }
+
+  size_t hash() const
+  {
+    // The bits are pseudo-random already; just fold them together.
+    word_type result = 0;
+    for (size_t w = 0; w < number_of_words; ++w)
+      result = (result ^ m_words[w]) * 0x9E3779B97F4A7C15;
+    return static_cast<size_t>(result ^ (result >> 32));
+  }
+
+  friend bool operator==(Signature const& signature1, Signature const& signature2) { return signature1.m_words == signature2.m_words; }
+  friend bool operator!=(Signature const& signature1, Signature const& signature2) { return signature1.m_words != signature2.m_words; }
+};
+
+} // namespace boolean
+
+namespace std {
+
+template<>
+struct hash<boolean::Signature>
+{
+  size_t operator()(boolean::Signature const& signature) const { return signature.hash(); }
+};
+
+} // namespace std
@@ -0,0 +1,193 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief Definition of SizeEstimator in namespace boolean.
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "sys.h"
+#include "debug.h"
+#include "SizeEstimator.h"
+#include "BitOperations.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace boolean {
+
+namespace {
+
+// The number of different products of the variables in used (each variable absent, negated or not negated).
+double number_of_products(Product::mask_type used)
+{
+  return std::pow(3.0, __builtin_popcountll(used));
+}
+
+} // namespace
+
+SizeEstimator::SizeEstimator(unsigned int number_of_samples, uint64_t seed) : m_number_of_samples(number_of_samples), m_state(seed)
+{
+  ASSERT(number_of_samples > 0);
+}
+
+// Return a pseudo-random number in the range [0, size).
+size_t SizeEstimator::random_index(size_t size)
+{
+  uint64_t const z = next_random(m_state);
+  return (static_cast<unsigned __int128>(z) * size) >> 64;
+}
+
+//static
+double SizeEstimator::times_upper_bound(Expression const& expression1, Expression const& expression2)
+{
+  ASSERT(expression1.is_initialized() && expression2.is_initialized());
+  if (expression1.is_literal() || expression2.is_literal())
+  {
+    if (expression1.is_zero() || expression2.is_zero())
+      return 1;
+    return expression1.is_one() ? expression2.products().size() : expression1.products().size();
+  }
+  Product::mask_type used = 0;
+  for (auto&& term : expression1.products())
+    used |= term.care_mask();
+  for (auto&& term : expression2.products())
+    used |= term.care_mask();
+  double const pairs = static_cast<double>(expression1.products().size()) * expression2.products().size();
+  double bound = std::min(pairs, number_of_products(used));
+  if (pairs <= exact_count_limit)
+  {
+    // Only pairs without a variable that has a different negation contribute a term.
+    size_t count = 0;
+    for (auto&& term1 : expression1.products())
+      for (auto&& term2 : expression2.products())
+        count += (term1.care_mask() & term2.care_mask() & (term1.negation_mask() ^ term2.negation_mask())) == 0;
+    bound = std::min(bound, static_cast<double>(count));
+  }
+  return std::max(bound, 1.0);          // Zero is represented by a single term.
+}
+
+//static
+double SizeEstimator::inverse_upper_bound(Expression const& expression)
+{
+  ASSERT(expression.is_initialized());
+  if (expression.is_literal())
+    return 1;
+  // Every term of the inverse is the product of one inverted variable of each term.
+  Product::mask_type used = 0;
+  double choices = 1;
+  for (auto&& term : expression.products())
+  {
+    used |= term.care_mask();
+    choices *= term.number_of_variables();
+  }
+  return std::min(choices, number_of_products(used));
+}
+
+SizeEstimate SizeEstimator::times(Expression const& expression1, Expression const& expression2)
+{
+  double const upper_bound = times_upper_bound(expression1, expression2);
+  if (expression1.is_literal() || expression2.is_literal())
+    return { upper_bound, upper_bound };
+  Span<Product const> const terms1 = expression1.products();
+  Span<Product const> const terms2 = expression2.products();
+  double const pairs = static_cast<double>(terms1.size()) * terms2.size();
+  std::vector<Product> products;
+  size_t number_of_tries;
+  if (pairs <= m_number_of_samples)
+  {
+    // Just try all of them.
+    number_of_tries = pairs;
+    for (auto&& term1 : terms1)
+      for (auto&& term2 : terms2)
+        products.push_back(term1 * term2);
+  }
+  else
+  {
+    number_of_tries = m_number_of_samples;
+    for (unsigned int sample = 0; sample < m_number_of_samples; ++sample)
+      products.push_back(terms1[random_index(terms1.size())] * terms2[random_index(terms2.size())]);
+  }
+  products.erase(std::remove_if(products.begin(), products.end(), [](Product const& product){ return product.is_zero(); }), products.end());
+  if (products.empty())
+    return { upper_bound, 1.0 };
+  // The estimated number of non-zero products, times the factor by which simplification reduces the sample.
+  double const non_zero = pairs * products.size() / number_of_tries;
+  double const reduction = static_cast<double>(Expression::sum_of(products).products().size()) / products.size();
+  return { upper_bound, std::min(upper_bound, std::max(1.0, non_zero * reduction)) };
+}
+
+SizeEstimate SizeEstimator::inverse(Expression const& expression)
+{
+  double const upper_bound = inverse_upper_bound(expression);
+  if (expression.is_literal())
+    return { upper_bound, upper_bound };
+  Span<Product const> const terms = expression.products();
+  size_t const number_of_terms = terms.size();
+  std::vector<size_t> sizes(number_of_terms);
+  double choices = 1;
+  for (size_t i = 0; i < number_of_terms; ++i)
+  {
+    sizes[i] = terms[i].number_of_variables();
+    choices *= sizes[i];
+  }
+  // A choice of one inverted variable per term; enumerated when there are few, otherwise random.
+  bool const exhaustive = choices <= m_number_of_samples;
+  size_t const number_of_tries = exhaustive ? choices : m_number_of_samples;
+  std::vector<size_t> choice(number_of_terms, 0);
+  double sum = 0;
+  for (size_t n = 0; n < number_of_tries; ++n)
+  {
+    Product product(true);
+    for (size_t i = 0; i < number_of_terms && !product.is_zero(); ++i)
+    {
+      size_t const k = exhaustive ? choice[i] : random_index(sizes[i]);
+      Product::mask_type const bit = pdep(Product::mask_type{1} << k, terms[i].care_mask());      // The k-th variable of the term.
+      product *= Product(~bit, (terms[i].negation_mask() & bit) ? ~bit : Product::full_mask);
+    }
+    if (exhaustive)
+    {
+      // Next choice (mixed radix counter).
+      for (size_t i = 0; i < number_of_terms && ++choice[i] == sizes[i]; ++i)
+        choice[i] = 0;
+    }
+    if (product.is_zero())
+      continue;
+    // The same product results from every choice of, per term, one of the variables of product that the term has inverted.
+    // Weight the product with the inverse of the fraction of choices that result in it, so that every product counts once.
+    // A product is only left after absorption when every variable of it is the only one chosen from some term.
+    Product::mask_type const used = product.care_mask();
+    Product::mask_type needed = 0;
+    double weight = 1;
+    for (size_t i = 0; i < number_of_terms; ++i)
+    {
+      Product::mask_type const hits = terms[i].care_mask() & used & (terms[i].negation_mask() ^ product.negation_mask());
+      int const count = __builtin_popcountll(hits);
+      weight *= static_cast<double>(sizes[i]) / count;
+      if (count == 1)
+        needed |= hits;
+    }
+    if (needed == used)
+      sum += weight;
+  }
+  return { upper_bound, std::min(upper_bound, std::max(1.0, sum / number_of_tries)) };
+}
+
+} // namespace boolean
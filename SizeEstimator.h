@@ -0,0 +1,91 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief Definition of SizeEstimator in namespace boolean.
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+// Usage:
+//
+// Estimate the number of terms of a.times(b) or e.inverse() before running
+// the operation, so that expensive operations can be deferred or rejected.
+//
+// SizeEstimator estimator;                     // 1024 samples per estimate.
+// SizeEstimate size = estimator.inverse(e);
+// if (size.m_upper_bound > limit && size.m_estimate > limit)
+//   ; // Too expensive.
+//
+// m_upper_bound is a hard limit on the number of terms, both of the result
+// and of the intermediate, unsimplified sum. It is a double because it can
+// be astronomically large.
+//
+// m_estimate is an estimate of the number of terms of the simplified result,
+// obtained by random sampling:
+// - times: the fraction of sampled pairs of terms that do not conflict, times
+//   the factor by which Expression::simplify reduces the sampled products.
+//   Because a sample has fewer terms to merge with, this tends to overestimate.
+// - inverse: every term of the inverse picks one inverted variable of each term
+//   of e. Sampling such choices at random, and weighting each non-zero choice
+//   that isn't absorbed by a smaller one with the inverse of its probability,
+//   gives an unbiased estimate of the number of terms left after absorption.
+//   The weights vary a lot, so expect a large spread when e has many terms.
+//   When there are at most number_of_samples choices they are all enumerated.
+//
+// The estimators take time proportional to the number of samples times the
+// number of terms of the input; times_upper_bound also does one conflict test
+// per pair of terms when there are at most exact_count_limit pairs.
+
+#pragma once
+
+#include "BooleanExpression.h"
+#include <cstdint>
+
+namespace boolean {
+
+struct SizeEstimate
+{
+  double m_upper_bound;         // The result has at most this many terms.
+  double m_estimate;            // The estimated number of terms of the result.
+};
+
+class SizeEstimator
+{
+ public:
+  static constexpr double exact_count_limit = 1 << 26;  // Count non-conflicting pairs exactly up to this many pairs.
+
+ private:
+  unsigned int m_number_of_samples;
+  uint64_t m_state;                                     // State of the pseudo-random number generator.
+
+ public:
+  SizeEstimator(unsigned int number_of_samples = 1024, uint64_t seed = 0x65737469);
+
+  static double times_upper_bound(Expression const& expression1, Expression const& expression2);
+  static double inverse_upper_bound(Expression const& expression);
+
+  SizeEstimate times(Expression const& expression1, Expression const& expression2);
+  SizeEstimate inverse(Expression const& expression);
+
+ private:
+  size_t random_index(size_t size);
+};
+
+} // namespace boolean
@@ -25,25 +25,46 @@
 
 #include "sys.h"
 #include "TruthProduct.h"
+#include "BitOperations.h"
+#include <algorithm>
 
 namespace boolean {
 
 TruthProduct& TruthProduct::operator++()
 {
-  mask_type bit{1};
-  for (Variable::id_type i = 0; i < max_number_of_variables; ++i, bit <<= 1)
-  {
-    if (!(m_variables & bit))   // Variable in use?
-    {
-      if (!(m_negation & bit))  // Not yet negated?
-      {
-        m_negation |= bit;
-        break;
-      }
-      m_negation &= ~bit;
-    }
-  }
+  // Count in the negation bits of the variables that are in use; the bits of the other variables are set in both masks.
+  mask_type const used = ~m_variables;
+  // Without variables (for example the literal one) there is only one assignment.
+  if (used == 0)
+    return *this;
+  m_negation = next_subset(m_negation & used, used) | m_variables;
   return *this;
 }
 
+//static
+TruthProduct TruthProduct::nth(index_type index, mask_type variable_mask)
+{
+  ASSERT((variable_mask & ~all_variables) == 0);
+  // The only assignment of no variables is the empty product, one (both masks below would be full, which is not one).
+  if (variable_mask == 0)
+    return TruthProduct();
+  // Variables that are not in use have their bit set in both masks; variables that are in use
+  // are negated when the corresponding bit of index is set.
+  TruthProduct result;
+  result.m_variables = ~variable_mask;
+  result.m_negation = ~variable_mask | pdep(index, variable_mask);
+  return result;
+}
+
+TruthProductRange TruthProductRange::chunk(index_type i, index_type number_of_chunks) const
+{
+  ASSERT(i < number_of_chunks);
+  // Distribute the remainder over the first chunks, so that chunk sizes differ at most one.
+  index_type const chunk_size = size() / number_of_chunks;
+  index_type const remainder = size() % number_of_chunks;
+  index_type const begin = m_begin + i * chunk_size + std::min(i, remainder);
+  index_type const end = begin + chunk_size + (i < remainder ? 1 : 0);
+  return { m_variable_mask, begin, end };
+}
+
 } // namespace boolean
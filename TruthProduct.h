@@ -36,6 +36,20 @@
 // TruthProduct tp = B * !C;
 // assert(expr(tp).is_one());   // Because when B is true and C is false then
 //                              // !A * B + A * !C = !A + A = 1.
+//
+// All assignments of a set of variables can be enumerated by incrementing
+// a TruthProduct, or by index: nth(index, variable_mask) returns the same
+// TruthProduct as incrementing index times, starting from all variables
+// in variable_mask being true. Bit i of index is the negation of the i-th
+// variable (counting from the least significant bit) of variable_mask.
+//
+// A TruthProductRange represents a range of such indices and can be split
+// into disjoint chunks, for example to divide the work over threads:
+//
+// TruthProductRange all(variable_mask);
+// // In thread t of n:
+// for (TruthProduct const& tp : all.chunk(t, n))
+//   ... expr(tp) ...
 
 #pragma once
 
@@ -46,12 +60,67 @@ namespace boolean {
 class TruthProduct : public Product
 {
  public:
+  using index_type = uint64_t;
+
   using Product::Product;
   TruthProduct() : Product(true) { }
   TruthProduct(int number_of_booleans) { m_variables = m_negation = full_mask << number_of_booleans; }
   explicit TruthProduct(Product const& product) : Product(product) { }
 
   TruthProduct& operator++();
+
+  // Return the index'th assignment of the variables whose bit is set in variable_mask.
+  static TruthProduct nth(index_type index, mask_type variable_mask);
+};
+
+class TruthProductRange
+{
+ public:
+  using mask_type = Product::mask_type;
+  using index_type = TruthProduct::index_type;
+
+  class iterator
+  {
+   private:
+    TruthProduct m_truth_product;
+    index_type m_index;
+
+   public:
+    iterator(index_type index, mask_type variable_mask) : m_truth_product(TruthProduct::nth(index, variable_mask)), m_index(index) { }
+
+    TruthProduct const& operator*() const { return m_truth_product; }
+    TruthProduct const* operator->() const { return &m_truth_product; }
+    iterator& operator++() { ++m_truth_product; ++m_index; return *this; }
+    index_type index() const { return m_index; }
+
+    friend bool operator==(iterator const& iter1, iterator const& iter2) { return iter1.m_index == iter2.m_index; }
+    friend bool operator!=(iterator const& iter1, iterator const& iter2) { return iter1.m_index != iter2.m_index; }
+  };
+
+ private:
+  mask_type m_variable_mask;    // The variables that are enumerated (a set bit means the variable is used).
+  index_type m_begin;           // Index of the first assignment in the range.
+  index_type m_end;             // One past the index of the last assignment in the range.
+
+ public:
+  // Construct the range of all assignments of the variables in variable_mask.
+  TruthProductRange(mask_type variable_mask) :
+    m_variable_mask(variable_mask), m_begin(0), m_end(index_type{1} << __builtin_popcountll(variable_mask))
+    { ASSERT((variable_mask & ~Product::all_variables) == 0); }
+
+  // Construct the range [begin, end) of assignments of the variables in variable_mask.
+  TruthProductRange(mask_type variable_mask, index_type begin, index_type end) :
+    m_variable_mask(variable_mask), m_begin(begin), m_end(end)
+    { ASSERT((variable_mask & ~Product::all_variables) == 0 && begin <= end); }
+
+  // Return the i-th of number_of_chunks disjoint ranges that together cover this range.
+  TruthProductRange chunk(index_type i, index_type number_of_chunks) const;
+
+  mask_type variable_mask() const { return m_variable_mask; }
+  index_type size() const { return m_end - m_begin; }
+  bool empty() const { return m_begin == m_end; }
+  iterator begin() const { return { m_begin, m_variable_mask }; }
+  iterator end() const { return { m_end, m_variable_mask }; }
 };
 
 } // namespace boolean
@@ -0,0 +1,193 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief Definition of PerfCounters and Benchmark in namespace boolean.
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "sys.h"
+#include "debug.h"
+#include "PerfCounters.h"
+#include <chrono>
+#include <iomanip>
+#include <ostream>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace boolean {
+
+namespace {
+
+double now_in_nanoseconds()
+{
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Used to keep the compiler from optimizing away results that are not used.
+size_t volatile s_sink;
+
+} // namespace
+
+PerfCounters::PerfCounters() : m_start{}, m_start_nanoseconds(0)
+{
+  m_fd.fill(-1);
+#ifdef __linux__
+  static uint64_t const config[number_of_counters] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+  };
+  for (int counter = 0; counter < number_of_counters; ++counter)
+  {
+    perf_event_attr attr = {};
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config[counter];
+    attr.exclude_kernel = 1;    // Allowed with the default perf_event_paranoid setting.
+    attr.exclude_hv = 1;
+    // Count the calling thread, on any CPU.
+    m_fd[counter] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+  }
+  Dout(dc::notice, "PerfCounters: " << (available() ? "available" : "not available") << '.');
+#endif
+}
+
+PerfCounters::~PerfCounters()
+{
+#ifdef __linux__
+  for (int fd : m_fd)
+    if (fd != -1)
+      close(fd);
+#endif
+}
+
+bool PerfCounters::available() const
+{
+  for (int fd : m_fd)
+    if (fd != -1)
+      return true;
+  return false;
+}
+
+void PerfCounters::read(std::array<uint64_t, number_of_counters>& values) const
+{
+  for (int counter = 0; counter < number_of_counters; ++counter)
+  {
+    values[counter] = 0;
+#ifdef __linux__
+    if (m_fd[counter] != -1 && ::read(m_fd[counter], &values[counter], sizeof(uint64_t)) != sizeof(uint64_t))
+      values[counter] = 0;
+#endif
+  }
+}
+
+void PerfCounters::start()
+{
+  read(m_start);
+  m_start_nanoseconds = now_in_nanoseconds();
+}
+
+PerfCounters::Sample PerfCounters::stop()
+{
+  Sample sample;
+  sample.m_nanoseconds = now_in_nanoseconds() - m_start_nanoseconds;
+  read(sample.m_value);
+  for (int counter = 0; counter < number_of_counters; ++counter)
+  {
+    sample.m_value[counter] -= m_start[counter];
+    sample.m_valid[counter] = m_fd[counter] != -1;
+  }
+  return sample;
+}
+
+//static
+char const* PerfCounters::name_of(counter_type counter)
+{
+  static char const* const names[number_of_counters] = { "cycles", "instructions", "cache-misses", "branch-misses" };
+  return names[counter];
+}
+
+//static
+Benchmark::Result Benchmark::average(std::string const& operation, size_t repetitions, PerfCounters::Sample const& total)
+{
+  ASSERT(repetitions > 0);
+  Result result{ operation, repetitions, total };
+  result.m_per_repetition.m_nanoseconds /= repetitions;
+  for (auto& value : result.m_per_repetition.m_value)
+    value /= repetitions;
+  return result;
+}
+
+Benchmark::Result Benchmark::sum_of(std::vector<Product> const& products, size_t repetitions)
+{
+  // Includes the time to copy products.
+  return measure("sum_of", repetitions, [&](){ s_sink = Expression::sum_of(products).products().size(); });
+}
+
+Benchmark::Result Benchmark::times(Expression const& expression1, Expression const& expression2, size_t repetitions)
+{
+  return measure("times", repetitions, [&](){ s_sink = expression1.times(expression2).products().size(); });
+}
+
+Benchmark::Result Benchmark::inverse(Expression const& expression, size_t repetitions)
+{
+  return measure("inverse", repetitions, [&](){ s_sink = expression.inverse().products().size(); });
+}
+
+Benchmark::Result Benchmark::equivalent(Expression const& expression1, Expression const& expression2, size_t repetitions)
+{
+  return measure("equivalent", repetitions, [&](){ s_sink = expression1.equivalent(expression2); });
+}
+
+Benchmark::Result Benchmark::evaluate(Expression const& expression, std::vector<Product::mask_type> const& assignments, size_t repetitions)
+{
+  return measure("evaluate", repetitions, [&](){
+      size_t count = 0;
+      for (auto set_variables : assignments)
+        count += expression.evaluate(set_variables);
+      s_sink = count;
+    });
+}
+
+//static
+void Benchmark::print(std::ostream& os, std::vector<Result> const& results)
+{
+  os << std::left << std::setw(12) << "operation" << std::right << std::setw(14) << "ns/op";
+  for (int counter = 0; counter < PerfCounters::number_of_counters; ++counter)
+    os << std::setw(16) << PerfCounters::name_of(static_cast<PerfCounters::counter_type>(counter));
+  os << '\n';
+  for (auto&& result : results)
+  {
+    os << std::left << std::setw(12) << result.m_operation << std::right << std::setw(14) << std::fixed << std::setprecision(1) << result.m_per_repetition.m_nanoseconds;
+    for (int counter = 0; counter < PerfCounters::number_of_counters; ++counter)
+    {
+      os << std::setw(16);
+      if (result.m_per_repetition.m_valid[counter])
+        os << result.m_per_repetition.m_value[counter];
+      else
+        os << '-';
+    }
+    os << '\n';
+  }
+}
+
+} // namespace boolean
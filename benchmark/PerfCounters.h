@@ -0,0 +1,135 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief Definition of PerfCounters in namespace boolean.
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+// Usage:
+//
+// Hardware performance counters of the calling thread (Linux perf_event_open).
+//
+// PerfCounters counters;
+// counters.start();
+// ... code to measure ...
+// PerfCounters::Sample sample = counters.stop();
+// if (sample.m_valid[PerfCounters::cycles])
+//   std::cout << sample.m_value[PerfCounters::cycles] << " cycles";
+//
+// Counters that can not be opened (not Linux, no permission because of
+// /proc/sys/kernel/perf_event_paranoid, or not supported by the (virtual)
+// CPU) are simply not valid; the wall clock time is always measured.
+//
+// A Benchmark measures the library operations with these counters:
+//
+// Benchmark benchmark;
+// std::vector<Benchmark::Result> results;
+// results.push_back(benchmark.times(a, b, 100));      // 100 repetitions.
+// results.push_back(benchmark.inverse(a, 100));
+// Benchmark::print(std::cout, results);              // Per operation: time and counter deltas.
+//
+// Not part of the library: benchmark/operation_benchmark runs a Benchmark on random Expressions.
+
+#pragma once
+
+#include "BooleanExpression.h"
+#include <array>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace boolean {
+
+class PerfCounters
+{
+ public:
+  enum counter_type { cycles, instructions, cache_misses, branch_misses, number_of_counters };
+
+  struct Sample
+  {
+    double m_nanoseconds;
+    std::array<uint64_t, number_of_counters> m_value;
+    std::array<bool, number_of_counters> m_valid;
+  };
+
+ private:
+  std::array<int, number_of_counters> m_fd;     // File descriptor of each counter, or -1.
+  std::array<uint64_t, number_of_counters> m_start;
+  double m_start_nanoseconds;
+
+ public:
+  PerfCounters();
+  ~PerfCounters();
+  PerfCounters(PerfCounters const&) = delete;
+  PerfCounters& operator=(PerfCounters const&) = delete;
+
+  // Return true if at least one counter could be opened.
+  bool available() const;
+
+  void start();
+  // Return the counter deltas and the time since the last call to start().
+  Sample stop();
+
+  static char const* name_of(counter_type counter);
+
+ private:
+  void read(std::array<uint64_t, number_of_counters>& values) const;
+};
+
+class Benchmark
+{
+ public:
+  struct Result
+  {
+    std::string m_operation;
+    size_t m_repetitions;
+    PerfCounters::Sample m_per_repetition;      // The counter deltas and time of one repetition (averaged).
+  };
+
+ private:
+  PerfCounters m_counters;
+
+ public:
+  // Run function repetitions times and return the averages.
+  template<typename Function>
+  Result measure(std::string const& operation, size_t repetitions, Function&& function)
+  {
+    m_counters.start();
+    for (size_t i = 0; i < repetitions; ++i)
+      function();
+    return average(operation, repetitions, m_counters.stop());
+  }
+
+  Result sum_of(std::vector<Product> const& products, size_t repetitions);      // Sort and simplify an unordered batch of terms.
+  Result times(Expression const& expression1, Expression const& expression2, size_t repetitions);
+  Result inverse(Expression const& expression, size_t repetitions);
+  Result equivalent(Expression const& expression1, Expression const& expression2, size_t repetitions);
+  Result evaluate(Expression const& expression, std::vector<Product::mask_type> const& assignments, size_t repetitions);
+
+  // Print one line per result.
+  static void print(std::ostream& os, std::vector<Result> const& results);
+
+ private:
+  static Result average(std::string const& operation, size_t repetitions, PerfCounters::Sample const& total);
+};
+
+} // namespace boolean
@@ -0,0 +1,50 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief Implementation of random_products.
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "sys.h"
+#include "debug.h"
+#include "RandomProducts.h"
+#include "BitOperations.h"
+
+namespace boolean {
+
+std::vector<Product> random_products(std::vector<Variable> const& variables, int terms, int literals, uint64_t& state)
+{
+  ASSERT(!variables.empty());
+  std::vector<Product> products;
+  for (int t = 0; t < terms; ++t)
+  {
+    Product product(true);
+    for (int l = 0; l < literals; ++l)
+    {
+      uint64_t const random = next_random(state);
+      product *= Product(variables[random % variables.size()], (random >> 32) & 1);
+    }
+    products.push_back(product);
+  }
+  return products;
+}
+
+} // namespace boolean
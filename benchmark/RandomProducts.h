@@ -0,0 +1,43 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief Declaration of random_products, the random input of the benchmark programs.
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+// Usage:
+//
+// uint64_t state = seed;
+// Expression e = Expression::sum_of(random_products(variables, 8, 4, state));  // A random sum of 8 terms of at most 4 literals.
+
+#pragma once
+
+#include "BooleanExpression.h"
+#include <cstdint>
+#include <vector>
+
+namespace boolean {
+
+// Return terms products of (at most, when a variable is drawn twice) literals literals each,
+// over variables, advancing the random state.
+std::vector<Product> random_products(std::vector<Variable> const& variables, int terms, int literals, uint64_t& state);
+
+} // namespace boolean
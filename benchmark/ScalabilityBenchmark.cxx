@@ -0,0 +1,174 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief Definition of ScalabilityBenchmark in namespace boolean.
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "sys.h"
+#include "debug.h"
+#include "ScalabilityBenchmark.h"
+#include "BitOperations.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <ostream>
+#include <thread>
+
+namespace boolean {
+
+namespace {
+
+char const* const s_operation_names[ScalabilityBenchmark::number_of_operations] = {
+  "sum", "times", "inverse", "evaluate", "to_string"
+};
+
+// Used to keep the compiler from optimizing away results that are not used.
+std::atomic<size_t> s_sink;
+
+double percentile(std::vector<float> const& sorted, double fraction)
+{
+  if (sorted.empty())
+    return 0;
+  return sorted[std::min(sorted.size() - 1, static_cast<size_t>(fraction * sorted.size()))];
+}
+
+} // namespace
+
+ScalabilityBenchmark::ScalabilityBenchmark(std::vector<Expression> const& inputs, Mix const& mix, size_t operations_per_thread) :
+  m_inputs(inputs), m_mix(mix), m_operations_per_thread(operations_per_thread)
+{
+  ASSERT(!inputs.empty());
+  ASSERT(std::any_of(mix.m_weight.begin(), mix.m_weight.end(), [](unsigned int weight){ return weight > 0; }));
+}
+
+void ScalabilityBenchmark::run_thread(unsigned int thread, std::vector<float>& latencies) const
+{
+  uint64_t state = thread;
+  unsigned int total_weight = 0;
+  for (unsigned int weight : m_mix.m_weight)
+    total_weight += weight;
+  size_t sink = 0;
+  for (size_t n = 0; n < m_operations_per_thread; ++n)
+  {
+    // Choose an operation with probability proportional to its weight, and its operands.
+    unsigned int choice = next_random(state) % total_weight;
+    int operation = 0;
+    while (choice >= m_mix.m_weight[operation])
+      choice -= m_mix.m_weight[operation++];
+    Expression const& a(m_inputs[next_random(state) % m_inputs.size()]);
+    Expression const& b(m_inputs[next_random(state) % m_inputs.size()]);
+    uint64_t const values = next_random(state);
+
+    auto const start = std::chrono::steady_clock::now();
+    switch (operation)
+    {
+      case op_sum:
+        sink += (a + b).products().size();
+        break;
+      case op_times:
+        sink += a.times(b).products().size();
+        break;
+      case op_inverse:
+        sink += a.inverse().products().size();
+        break;
+      case op_evaluate:
+        for (int i = 0; i < 64; ++i)
+          sink += a.evaluate(values * (i + 1));
+        break;
+      case op_to_string:
+        for (Product const& term : a.products())
+          sink += term.to_string().size();
+        break;
+    }
+    auto const stop = std::chrono::steady_clock::now();
+    latencies.push_back(std::chrono::duration<float, std::nano>(stop - start).count());
+  }
+  s_sink += sink;
+}
+
+std::vector<ScalabilityBenchmark::Result> ScalabilityBenchmark::run(std::vector<unsigned int> const& thread_counts)
+{
+  std::vector<Result> results;
+  for (unsigned int number_of_threads : thread_counts)
+  {
+    ASSERT(number_of_threads > 0);
+    std::vector<std::vector<float>> latencies(number_of_threads);
+    for (auto& thread_latencies : latencies)
+      thread_latencies.reserve(m_operations_per_thread);
+    // Let all threads start at the same time.
+    std::atomic<unsigned int> ready(0);
+    std::atomic<bool> go(false);
+    std::vector<std::thread> threads;
+    for (unsigned int thread = 0; thread < number_of_threads; ++thread)
+      threads.emplace_back([&, thread](){
+          ready.fetch_add(1);
+          while (!go.load(std::memory_order_acquire))
+            std::this_thread::yield();
+          run_thread(thread, latencies[thread]);
+        });
+    while (ready.load() != number_of_threads)
+      std::this_thread::yield();
+    auto const start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& thread : threads)
+      thread.join();
+    auto const stop = std::chrono::steady_clock::now();
+
+    std::vector<float> all;
+    all.reserve(number_of_threads * m_operations_per_thread);
+    for (auto&& thread_latencies : latencies)
+      all.insert(all.end(), thread_latencies.begin(), thread_latencies.end());
+    std::sort(all.begin(), all.end());
+    Result result;
+    result.m_threads = number_of_threads;
+    result.m_seconds = std::chrono::duration<double>(stop - start).count();
+    result.m_operations_per_second = all.size() / result.m_seconds;
+    double const per_thread = result.m_operations_per_second / number_of_threads;
+    result.m_efficiency = results.empty() ? 1.0 : per_thread / (results[0].m_operations_per_second / results[0].m_threads);
+    result.m_p50_nanoseconds = percentile(all, 0.5);
+    result.m_p99_nanoseconds = percentile(all, 0.99);
+    result.m_p999_nanoseconds = percentile(all, 0.999);
+    result.m_max_nanoseconds = all.empty() ? 0 : all.back();
+    results.push_back(result);
+  }
+  return results;
+}
+
+//static
+void ScalabilityBenchmark::print(std::ostream& os, std::vector<Result> const& results)
+{
+  os << std::setw(8) << "threads" << std::setw(14) << "ops/s" << std::setw(12) << "efficiency" <<
+    std::setw(12) << "p50 ns" << std::setw(12) << "p99 ns" << std::setw(12) << "p99.9 ns" << std::setw(12) << "max ns" << '\n';
+  for (auto&& result : results)
+    os << std::fixed << std::setprecision(0) << std::setw(8) << result.m_threads << std::setw(14) << result.m_operations_per_second <<
+      std::setprecision(2) << std::setw(12) << result.m_efficiency << std::setprecision(0) << std::setw(12) << result.m_p50_nanoseconds <<
+      std::setw(12) << result.m_p99_nanoseconds << std::setw(12) << result.m_p999_nanoseconds << std::setw(12) << result.m_max_nanoseconds << '\n';
+}
+
+//static
+char const* ScalabilityBenchmark::name_of(operation_type operation)
+{
+  return s_operation_names[operation];
+}
+
+} // namespace boolean
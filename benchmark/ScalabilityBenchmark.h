@@ -0,0 +1,112 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief Definition of ScalabilityBenchmark in namespace boolean.
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+// Usage:
+//
+// Run a mix of operations on a shared pool of input Expressions with an
+// increasing number of threads, to find contention (the heap, shared
+// cache lines, the Context singleton).
+//
+// ScalabilityBenchmark::Mix mix;               // Relative weights of the operations.
+// mix.m_weight[ScalabilityBenchmark::op_times] = 4;
+// ScalabilityBenchmark benchmark(inputs, mix, 10000);  // 10000 operations per thread.
+// auto results = benchmark.run({ 1, 2, 4, 8, 16, 32, 64 });
+// ScalabilityBenchmark::print(std::cout, results);
+//
+// Every thread does the same number of operations (weak scaling), so with
+// perfect scaling the throughput is proportional to the number of threads.
+// The efficiency is the throughput per thread relative to that of the first
+// run. Latencies are per operation, over all threads.
+//
+// The program benchmark/scalability_benchmark (scalability_benchmark.cxx) runs
+// it on random inputs, with the mix and thread counts from its command line.
+//
+// Only operations that don't modify their inputs are run concurrently:
+// Context::create_variable is not thread-safe. to_string does read the
+// Context concurrently.
+
+#pragma once
+
+#include "BooleanExpression.h"
+#include <array>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+namespace boolean {
+
+class ScalabilityBenchmark
+{
+ public:
+  enum operation_type
+  {
+    op_sum,                     // a + b
+    op_times,                   // a.times(b)
+    op_inverse,                 // a.inverse()
+    op_evaluate,                // a.evaluate(values) for 64 random values.
+    op_to_string,               // Print a to a string (looks up variable names in the Context).
+    number_of_operations
+  };
+
+  struct Mix
+  {
+    std::array<unsigned int, number_of_operations> m_weight;
+    Mix() { m_weight.fill(1); }
+  };
+
+  struct Result
+  {
+    unsigned int m_threads;
+    double m_seconds;                   // Wall clock time of the whole run.
+    double m_operations_per_second;
+    double m_efficiency;                // Throughput per thread relative to the first run.
+    double m_p50_nanoseconds;           // Median latency.
+    double m_p99_nanoseconds;
+    double m_p999_nanoseconds;
+    double m_max_nanoseconds;
+  };
+
+ private:
+  std::vector<Expression> const& m_inputs;
+  Mix m_mix;
+  size_t m_operations_per_thread;
+
+ public:
+  // inputs must stay alive and unchanged while running.
+  ScalabilityBenchmark(std::vector<Expression> const& inputs, Mix const& mix, size_t operations_per_thread);
+
+  // Do a run for every number of threads in thread_counts.
+  std::vector<Result> run(std::vector<unsigned int> const& thread_counts);
+
+  // Print one line per result.
+  static void print(std::ostream& os, std::vector<Result> const& results);
+
+  static char const* name_of(operation_type operation);
+
+ private:
+  void run_thread(unsigned int thread, std::vector<float>& latencies) const;
+};
+
+} // namespace boolean
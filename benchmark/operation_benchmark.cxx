@@ -0,0 +1,111 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief Measures the library operations on random Expressions with a Benchmark (time and hardware counters).
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+// Usage:
+//
+// operation_benchmark [--repetitions 100] [--assignments 1024] [--terms 8] [--literals 4] [--variables 16] [--seed 1]
+//
+// Prints, per operation (sum_of, times, inverse, equivalent and evaluate), the average time and
+// hardware counter deltas of one repetition. The inputs are two random sums of --terms products
+// of (at most) --literals literals each, over --variables variables; evaluate runs on --assignments
+// random assignments.
+
+#include "sys.h"
+#include "debug.h"
+#include "PerfCounters.h"
+#include "RandomProducts.h"
+#include "BitOperations.h"
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace boolean;
+
+int main(int argc, char* argv[])
+{
+  Debug(NAMESPACE_DEBUG::init());
+
+  size_t repetitions = 100;
+  size_t number_of_assignments = 1024;
+  int terms = 8;
+  int literals = 4;
+  int number_of_variables = 16;
+  uint64_t seed = 1;
+  for (int arg = 1; arg < argc; arg += 2)
+  {
+    std::string const option = argv[arg];
+    if (arg + 1 == argc)
+    {
+      std::cerr << "Missing value after " << option << '\n';
+      return 2;
+    }
+    char const* const value = argv[arg + 1];
+    if (option == "--repetitions")
+      repetitions = std::strtoul(value, nullptr, 10);
+    else if (option == "--assignments")
+      number_of_assignments = std::strtoul(value, nullptr, 10);
+    else if (option == "--terms")
+      terms = std::atoi(value);
+    else if (option == "--literals")
+      literals = std::atoi(value);
+    else if (option == "--variables")
+      number_of_variables = std::atoi(value);
+    else if (option == "--seed")
+      seed = std::strtoull(value, nullptr, 10);
+    else
+    {
+      std::cerr << "Unknown option " << option << '\n';
+      return 2;
+    }
+  }
+  if (repetitions == 0 || terms < 1 || literals < 1 || number_of_variables < 1 || number_of_variables > static_cast<int>(Product::max_number_of_variables))
+  {
+    std::cerr << "Invalid arguments.\n";
+    return 2;
+  }
+
+  Context& context{Context::instance()};
+  std::vector<Variable> variables;
+  for (int v = 0; v < number_of_variables; ++v)
+    variables.push_back(context.create_variable("x" + std::to_string(v)));
+
+  uint64_t state = seed;
+  std::vector<Product> products = random_products(variables, terms, literals, state);
+  Expression const a = Expression::sum_of(products);
+  Expression const b = Expression::sum_of(random_products(variables, terms, literals, state));
+  std::vector<Product::mask_type> assignments;
+  for (size_t i = 0; i < number_of_assignments; ++i)
+    assignments.push_back(next_random(state));
+
+  Benchmark benchmark;
+  std::vector<Benchmark::Result> results;
+  results.push_back(benchmark.sum_of(products, repetitions));
+  results.push_back(benchmark.times(a, b, repetitions));
+  results.push_back(benchmark.inverse(a, repetitions));
+  results.push_back(benchmark.equivalent(a, b, repetitions));
+  results.push_back(benchmark.evaluate(a, assignments, repetitions));
+  Benchmark::print(std::cout, results);
+}
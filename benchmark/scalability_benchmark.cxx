@@ -0,0 +1,159 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief Runs a ScalabilityBenchmark on random Expressions with a mix and thread counts from the command line.
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+// Usage:
+//
+// scalability_benchmark [--mix sum=1,times=4,...] [--threads 1,2,4,8] [--operations 1000]
+//                       [--inputs 64] [--terms 8] [--literals 4] [--variables 16] [--seed 1]
+//
+// --mix         Relative weights of the operations (sum, times, inverse, evaluate, to_string);
+//               operations that are not mentioned have weight zero. Default: all one.
+// --threads     The numbers of threads to run with, in this order. Default: 1, 2, 4, ... up to
+//               std::thread::hardware_concurrency().
+// --operations  The number of operations per thread.
+// The inputs are --inputs random sums of --terms products of (at most) --literals literals each, over --variables variables.
+
+#include "sys.h"
+#include "debug.h"
+#include "ScalabilityBenchmark.h"
+#include "RandomProducts.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace boolean;
+
+namespace {
+
+// Split a comma separated list.
+std::vector<std::string> split(std::string const& list)
+{
+  std::vector<std::string> result;
+  std::istringstream is(list);
+  std::string item;
+  while (std::getline(is, item, ','))
+    result.push_back(item);
+  return result;
+}
+
+bool parse_mix(std::string const& list, ScalabilityBenchmark::Mix& mix)
+{
+  mix.m_weight.fill(0);
+  for (auto&& item : split(list))
+  {
+    std::string::size_type const equals = item.find('=');
+    std::string const name = item.substr(0, equals);
+    int operation = 0;
+    while (operation < ScalabilityBenchmark::number_of_operations &&
+           name != ScalabilityBenchmark::name_of(static_cast<ScalabilityBenchmark::operation_type>(operation)))
+      ++operation;
+    if (operation == ScalabilityBenchmark::number_of_operations)
+      return false;
+    mix.m_weight[operation] = equals == std::string::npos ? 1 : std::strtoul(item.c_str() + equals + 1, nullptr, 10);
+  }
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  Debug(NAMESPACE_DEBUG::init());
+
+  ScalabilityBenchmark::Mix mix;
+  std::vector<unsigned int> thread_counts;
+  size_t operations = 1000;
+  size_t number_of_inputs = 64;
+  int terms = 8;
+  int literals = 4;
+  int number_of_variables = 16;
+  uint64_t seed = 1;
+  for (int arg = 1; arg < argc; arg += 2)
+  {
+    std::string const option = argv[arg];
+    if (arg + 1 == argc)
+    {
+      std::cerr << "Missing value after " << option << '\n';
+      return 2;
+    }
+    char const* const value = argv[arg + 1];
+    if (option == "--mix")
+    {
+      if (!parse_mix(value, mix))
+      {
+        std::cerr << "Unknown operation in --mix " << value << '\n';
+        return 2;
+      }
+    }
+    else if (option == "--threads")
+      for (auto&& count : split(value))
+        thread_counts.push_back(std::strtoul(count.c_str(), nullptr, 10));
+    else if (option == "--operations")
+      operations = std::strtoul(value, nullptr, 10);
+    else if (option == "--inputs")
+      number_of_inputs = std::strtoul(value, nullptr, 10);
+    else if (option == "--terms")
+      terms = std::atoi(value);
+    else if (option == "--literals")
+      literals = std::atoi(value);
+    else if (option == "--variables")
+      number_of_variables = std::atoi(value);
+    else if (option == "--seed")
+      seed = std::strtoull(value, nullptr, 10);
+    else
+    {
+      std::cerr << "Unknown option " << option << '\n';
+      return 2;
+    }
+  }
+  if (std::none_of(mix.m_weight.begin(), mix.m_weight.end(), [](unsigned int weight){ return weight > 0; }) ||
+      number_of_inputs == 0 || terms < 1 || literals < 1 || number_of_variables < 1 || number_of_variables > static_cast<int>(Product::max_number_of_variables))
+  {
+    std::cerr << "Invalid arguments.\n";
+    return 2;
+  }
+  if (thread_counts.empty())
+    for (unsigned int threads = 1; threads <= std::max(1u, std::thread::hardware_concurrency()); threads *= 2)
+      thread_counts.push_back(threads);
+
+  // The variables have to be created before the benchmark threads start.
+  Context& context{Context::instance()};
+  std::vector<Variable> variables;
+  for (int v = 0; v < number_of_variables; ++v)
+    variables.push_back(context.create_variable("x" + std::to_string(v)));
+
+  std::vector<Expression> inputs;
+  uint64_t state = seed;
+  for (size_t i = 0; i < number_of_inputs; ++i)
+    inputs.push_back(Expression::sum_of(random_products(variables, terms, literals, state)));
+
+  ScalabilityBenchmark benchmark(inputs, mix, operations);
+  ScalabilityBenchmark::print(std::cout, benchmark.run(thread_counts));
+}
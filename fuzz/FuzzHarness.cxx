@@ -0,0 +1,403 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief Definition of FuzzHarness in namespace boolean.
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "sys.h"
+#include "debug.h"
+#include "FuzzHarness.h"
+#include "BitOperations.h"
+#include "SizeEstimator.h"
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string_view>
+#include <system_error>
+
+namespace boolean {
+
+namespace {
+
+char const* const s_operation_names[FuzzHarness::number_of_operations] = {
+  "load", "add", "sum", "times", "inverse", "multiply", "copy", "literal"
+};
+
+char const* const s_kind_names[] = { "wrong result", "slow", "large", "blow-up" };
+
+// Encoding of an operation: one byte, followed by three bytes for a product operand.
+int constexpr product_size = 3;
+
+} // namespace
+
+FuzzHarness::FuzzHarness() : m_has_baseline(false), m_baseline{}, m_measured{}, m_variables(0)
+{
+  Context& context{Context::instance()};
+  for (int& index : m_index_of_id)
+    index = -1;
+  for (int j = 0; j < number_of_variables; ++j)
+  {
+    Variable const variable = context.get_or_create_variable("x" + std::to_string(j));
+    Product const product(variable);
+    ASSERT(product.care_mask() != 0);
+    m_ids[j] = *SetBits(product.care_mask()).begin();
+    m_index_of_id[m_ids[j]] = j;
+    m_variables |= product.care_mask();
+    // Variable j has the value of bit j of the index of the assignment.
+    for (size_t w = 0; w < truth_table_words; ++w)
+    {
+      if (j < 6)
+      {
+        uint64_t pattern = 0;
+        for (int b = 0; b < 64; ++b)
+          if (((b >> j) & 1))
+            pattern |= uint64_t{1} << b;
+        m_columns[j][w] = pattern;
+      }
+      else
+        m_columns[j][w] = ((w >> (j - 6)) & 1) ? ~uint64_t{0} : 0;
+    }
+  }
+}
+
+FuzzHarness::FuzzHarness(Baseline const& baseline) : FuzzHarness()
+{
+  m_has_baseline = true;
+  m_baseline = baseline;
+}
+
+void FuzzHarness::reset()
+{
+  for (int r = 0; r < number_of_registers; ++r)
+  {
+    m_registers[r] = false;
+    m_truth_tables[r].fill(0);
+  }
+}
+
+Product FuzzHarness::decode_product(uint8_t const* data) const
+{
+  uint32_t const bits = data[0] | (uint32_t{data[1]} << 8) | (uint32_t{data[2]} << 16);
+  uint32_t const used = bits & ((1u << number_of_variables) - 1);
+  uint32_t const negated = bits >> number_of_variables;
+  Product::mask_type care = 0;
+  Product::mask_type negation = 0;
+  for (int j : SetBits(used))
+  {
+    Product::mask_type const bit = Product::mask_type{1} << m_ids[j];
+    care |= bit;
+    if (((negated >> j) & 1))
+      negation |= bit;
+  }
+  return care == 0 ? Product(true) : Product(~care, ~care | negation);
+}
+
+FuzzHarness::truth_table_type FuzzHarness::truth_table(Product const& product) const
+{
+  truth_table_type result;
+  result.fill(product.is_zero() ? 0 : ~uint64_t{0});
+  if (product.is_literal())
+    return result;
+  for (Variable::id_type id : SetBits(product.care_mask()))
+  {
+    int const j = m_index_of_id[id];
+    ASSERT(j != -1);
+    uint64_t const invert = (product.value_mask() & (Product::mask_type{1} << id)) ? 0 : ~uint64_t{0};
+    for (size_t w = 0; w < truth_table_words; ++w)
+      result[w] &= m_columns[j][w] ^ invert;
+  }
+  return result;
+}
+
+FuzzHarness::truth_table_type FuzzHarness::truth_table(Expression const& expression) const
+{
+  truth_table_type result;
+  result.fill(0);
+  for (Product const& term : expression.products())
+  {
+    truth_table_type const term_table = truth_table(term);
+    for (size_t w = 0; w < truth_table_words; ++w)
+      result[w] |= term_table[w];
+  }
+  return result;
+}
+
+std::vector<FuzzHarness::Finding> FuzzHarness::run(uint8_t const* data, size_t size)
+{
+  std::vector<Finding> findings;
+  SizeEstimator estimator(256);
+  reset();
+  size_t offset = 0;
+  while (offset < size)
+  {
+    size_t const operation_offset = offset;
+    uint8_t const code = data[offset++];
+    operation_type const operation = static_cast<operation_type>(code & 7);
+    int const r = (code >> 3) & 3;
+    int const r1 = (code >> 5) & 3;
+    bool const needs_product = operation == op_load || operation == op_add || operation == op_multiply;
+    if (needs_product && size - offset < product_size)
+      break;
+    Product const product = needs_product ? decode_product(data + offset) : Product(true);
+    if (needs_product)
+      offset += product_size;
+
+    Expression const& lhs(m_registers[r1]);
+    Expression const& rhs(m_registers[r]);
+    std::ostringstream description;
+    description << 'r' << r << " = ";
+    double input_terms = 1;
+    if (operation == op_sum || operation == op_times)
+    {
+      description << 'r' << r1 << (operation == op_sum ? " + r" : ".times(r") << r << (operation == op_sum ? "" : ")");
+      input_terms = lhs.products().size() + rhs.products().size();
+    }
+    else if (operation == op_inverse || operation == op_multiply || operation == op_copy)
+    {
+      description << 'r' << r1 << (operation == op_inverse ? ".inverse()" : operation == op_multiply ? " * product" : ".copy()");
+      input_terms = lhs.products().size();
+    }
+    else if (operation == op_add)
+    {
+      description << 'r' << r << " + product";
+      input_terms = rhs.products().size() + 1;
+    }
+    else
+      description << (operation == op_literal ? "literal" : "product");
+
+    // Refuse to run operations that are expected to blow up.
+    if (operation == op_times || operation == op_inverse)
+    {
+      SizeEstimate const estimate = operation == op_times ? estimator.times(lhs, rhs) : estimator.inverse(lhs);
+      if (estimate.m_estimate > max_result_terms)
+      {
+        description << ": estimated " << estimate.m_estimate << " terms (upper bound " << estimate.m_upper_bound << "); not executed.";
+        findings.push_back({ Finding::blow_up, operation_offset, description.str() });
+        continue;
+      }
+    }
+
+    // Run the operation and the same operation on the truth tables.
+    truth_table_type expected;
+    Expression result;
+    Expression swapped;
+    auto const start = std::chrono::steady_clock::now();
+    switch (operation)
+    {
+      case op_load:
+        result = product;
+        break;
+      case op_add:
+        result = rhs.copy();
+        result += product;
+        break;
+      case op_sum:
+        result = lhs + rhs;
+        break;
+      case op_times:
+        result = lhs.times(rhs);
+        break;
+      case op_inverse:
+        result = lhs.inverse();
+        break;
+      case op_multiply:
+        result = lhs * product;
+        break;
+      case op_copy:
+        result = lhs.copy();
+        break;
+      case op_literal:
+        result = (code & 0x80) != 0;
+        break;
+      case number_of_operations:
+        break;
+    }
+    auto const stop = std::chrono::steady_clock::now();
+    truth_table_type const product_table = truth_table(product);
+    for (size_t w = 0; w < truth_table_words; ++w)
+    {
+      uint64_t const a = m_truth_tables[r1][w];
+      uint64_t const b = m_truth_tables[r][w];
+      switch (operation)
+      {
+        case op_load: expected[w] = product_table[w]; break;
+        case op_add: expected[w] = b | product_table[w]; break;
+        case op_sum: expected[w] = a | b; break;
+        case op_times: expected[w] = a & b; break;
+        case op_inverse: expected[w] = ~a; break;
+        case op_multiply: expected[w] = a & product_table[w]; break;
+        case op_copy: expected[w] = a; break;
+        case op_literal: expected[w] = (code & 0x80) ? ~uint64_t{0} : 0; break;
+        case number_of_operations: break;
+      }
+    }
+
+    // Check the result.
+    if (truth_table(result) != expected)
+      findings.push_back({ Finding::wrong_result, operation_offset, description.str() + ": result differs from the truth table." });
+    else if (operation == op_sum || operation == op_times)
+    {
+      swapped = operation == op_sum ? rhs + lhs : rhs.times(lhs);
+      if (!result.equivalent(swapped))
+        findings.push_back({ Finding::wrong_result, operation_offset, description.str() + ": not equivalent to the result with the operands swapped." });
+    }
+
+    // Compare the cost with the baseline.
+    double const nanoseconds = std::chrono::duration<double, std::nano>(stop - start).count();
+    double const result_terms = result.products().size();
+    double const work = (input_terms + result_terms) * (input_terms + result_terms);
+    double const time_ratio = nanoseconds / work;
+    double const size_ratio = result_terms / input_terms;
+    if (m_has_baseline)
+    {
+      double const time_limit = time_tolerance * m_baseline.m_nanoseconds_per_work[operation];
+      double const size_limit = size_tolerance * m_baseline.m_terms_per_input_term[operation];
+      if (time_limit > 0 && time_ratio > time_limit && nanoseconds >= min_flagged_nanoseconds)
+      {
+        std::ostringstream os;
+        os << description.str() << ": " << nanoseconds << " ns for " << input_terms << " input and " << result_terms <<
+          " result terms; " << (time_ratio / m_baseline.m_nanoseconds_per_work[operation]) << " times the baseline.";
+        findings.push_back({ Finding::slow, operation_offset, os.str() });
+      }
+      if (size_limit > 0 && size_ratio > size_limit)
+      {
+        std::ostringstream os;
+        os << description.str() << ": " << result_terms << " result terms for " << input_terms << " input terms; " <<
+          (size_ratio / m_baseline.m_terms_per_input_term[operation]) << " times the baseline.";
+        findings.push_back({ Finding::large, operation_offset, os.str() });
+      }
+    }
+    m_measured.m_nanoseconds_per_work[operation] = std::max(m_measured.m_nanoseconds_per_work[operation], time_ratio);
+    m_measured.m_terms_per_input_term[operation] = std::max(m_measured.m_terms_per_input_term[operation], size_ratio);
+
+    // Keep the registers in sync with their truth tables.
+    m_registers[r] = std::move(result);
+    m_truth_tables[r] = expected;
+  }
+  return findings;
+}
+
+int FuzzHarness::test_one_input(uint8_t const* data, size_t size)
+{
+  std::vector<Finding> const findings = run(data, size);
+  if (findings.empty())
+    return 0;
+  bool wrong_result = false;
+  for (auto&& finding : findings)
+  {
+    std::cerr << s_kind_names[finding.m_kind] << " at offset " << finding.m_offset << ": " << finding.m_description << std::endl;
+    wrong_result |= finding.m_kind == Finding::wrong_result;
+  }
+  if (wrong_result)
+    std::abort();
+  // Slow, large and blow-up are not bugs: keep the input as a benchmark candidate and continue fuzzing.
+  if (!m_cost_directory.empty())
+    save_input(data, size);
+  return 0;
+}
+
+void FuzzHarness::save_input(uint8_t const* data, size_t size) const
+{
+  std::string_view const bytes(reinterpret_cast<char const*>(data), size);
+  std::ostringstream filename;
+  filename << m_cost_directory << "/cost-" << std::hex << std::hash<std::string_view>{}(bytes);
+  std::ofstream file(filename.str(), std::ios::binary);
+  file.write(bytes.data(), bytes.size());
+  if (!file)
+    throw std::system_error(errno, std::generic_category(), "Error writing \"" + filename.str() + "\"");
+}
+
+size_t FuzzHarness::replay(std::vector<std::string> const& paths, std::ostream& os)
+{
+  std::vector<std::string> filenames;
+  for (auto&& path : paths)
+  {
+    if (std::filesystem::is_directory(path))
+    {
+      for (auto&& entry : std::filesystem::directory_iterator(path))
+        if (entry.is_regular_file())
+          filenames.push_back(entry.path().string());
+    }
+    else
+      filenames.push_back(path);
+  }
+  size_t failed = 0;
+  for (auto&& filename : filenames)
+  {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file)
+      throw std::system_error(errno, std::generic_category(), "Could not open \"" + filename + "\"");
+    std::vector<uint8_t> const data{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    std::vector<Finding> const findings = run(data.data(), data.size());
+    if (findings.empty())
+      continue;
+    ++failed;
+    for (auto&& finding : findings)
+      os << filename << ": " << s_kind_names[finding.m_kind] << " at offset " << finding.m_offset << ": " << finding.m_description << '\n';
+  }
+  return failed;
+}
+
+//static
+FuzzHarness::Baseline FuzzHarness::load_baseline(std::string const& filename)
+{
+  std::ifstream file(filename);
+  if (!file)
+    throw std::system_error(errno, std::generic_category(), "Could not open \"" + filename + "\"");
+  Baseline baseline{};
+  std::string name;
+  double nanoseconds_per_work;
+  double terms_per_input_term;
+  while (file >> name >> nanoseconds_per_work >> terms_per_input_term)
+    for (int operation = 0; operation < number_of_operations; ++operation)
+      if (name == s_operation_names[operation])
+      {
+        baseline.m_nanoseconds_per_work[operation] = nanoseconds_per_work;
+        baseline.m_terms_per_input_term[operation] = terms_per_input_term;
+      }
+  if (!file.eof())
+    throw std::system_error(std::make_error_code(std::errc::invalid_argument), "Error parsing \"" + filename + "\"");
+  return baseline;
+}
+
+//static
+void FuzzHarness::save_baseline(std::string const& filename, Baseline const& baseline)
+{
+  std::ofstream file(filename);
+  for (int operation = 0; operation < number_of_operations; ++operation)
+    file << s_operation_names[operation] << ' ' << baseline.m_nanoseconds_per_work[operation] << ' ' << baseline.m_terms_per_input_term[operation] << '\n';
+  if (!file)
+    throw std::system_error(errno, std::generic_category(), "Error writing \"" + filename + "\"");
+}
+
+//static
+char const* FuzzHarness::name_of(operation_type operation)
+{
+  return s_operation_names[operation];
+}
+
+} // namespace boolean
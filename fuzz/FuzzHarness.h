@@ -0,0 +1,162 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief Definition of FuzzHarness in namespace boolean.
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+// Usage:
+//
+// A FuzzHarness interprets a byte string as a program of Expression operations
+// on number_of_registers registers, over number_of_variables variables.
+// Every result is checked against a truth table that is maintained alongside
+// (with plain bitwise operations), and sums and products are also checked with
+// equivalent() against the same operation with the operands swapped.
+//
+// The time and the number of terms of each operation are compared with a
+// Baseline: the largest ratio of nanoseconds per unit of work, respectively of
+// result terms per input term, that was seen for that operation on a corpus of
+// known good inputs. A unit of work is the square of the number of input plus
+// result terms (simplify compares pairs of terms). Operations whose estimated
+// result (see SizeEstimator) exceeds max_result_terms are not executed but
+// reported as a blow-up.
+//
+// The libFuzzer target fuzz/fuzz_expression (fuzz_expression.cxx) calls test_one_input,
+// which aborts on a wrong result:
+//
+// static boolean::FuzzHarness harness(boolean::FuzzHarness::load_baseline("baseline.txt"));
+// return harness.test_one_input(data, size);
+//
+// Slow, large and blow-up findings don't abort the fuzzer; they are printed and, after
+// harness.set_cost_directory("cost/"), the input is saved there so it can be replayed.
+//
+// The program fuzz/replay_corpus (replay_corpus.cxx) replays files, or directories of files:
+//
+// FuzzHarness harness(FuzzHarness::load_baseline("baseline.txt"));
+// size_t failed = harness.replay({ "corpus/" }, std::cout);
+//
+// A baseline is made by replaying a known good corpus without one (replay_corpus --calibrate):
+//
+// FuzzHarness calibrate;
+// calibrate.replay({ "corpus/" }, std::cout);
+// FuzzHarness::save_baseline("baseline.txt", calibrate.measured());
+//
+// Inputs that are flagged as slow or large are the candidates for new benchmarks.
+
+#pragma once
+
+#include "BooleanExpression.h"
+#include <array>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace boolean {
+
+class FuzzHarness
+{
+ public:
+  static constexpr int number_of_variables = 12;
+  static constexpr int number_of_registers = 4;
+  static constexpr size_t truth_table_words = (size_t{1} << number_of_variables) / 64;
+  static constexpr double max_result_terms = 4096;              // Don't run operations with a larger estimated result.
+  static constexpr double time_tolerance = 8;                   // Flag operations that are this much slower (per unit of work) than the baseline.
+  static constexpr double size_tolerance = 4;                   // Flag results that are this much larger (per input term) than the baseline.
+  static constexpr double min_flagged_nanoseconds = 100000;     // Shorter operations are too noisy to flag as slow.
+
+  enum operation_type
+  {
+    op_load,                    // r = product.
+    op_add,                     // r += product.
+    op_sum,                     // r = r1 + r2.
+    op_times,                   // r = r1.times(r2).
+    op_inverse,                 // r = r1.inverse().
+    op_multiply,                // r = r1 * product.
+    op_copy,                    // r = r1.copy().
+    op_literal,                 // r = zero or one.
+    number_of_operations
+  };
+
+  struct Baseline
+  {
+    std::array<double, number_of_operations> m_nanoseconds_per_work;
+    std::array<double, number_of_operations> m_terms_per_input_term;
+  };
+
+  struct Finding
+  {
+    enum kind_type { wrong_result, slow, large, blow_up };
+    kind_type m_kind;
+    size_t m_offset;            // Offset of the operation in the input.
+    std::string m_description;
+  };
+
+ private:
+  using truth_table_type = std::array<uint64_t, truth_table_words>;
+
+  bool m_has_baseline;
+  Baseline m_baseline;
+  Baseline m_measured;                                  // The largest ratios seen so far.
+  Product::mask_type m_variables;                       // The masks of the fuzzed variables.
+  Variable::id_type m_ids[number_of_variables];
+  int m_index_of_id[Product::max_number_of_variables];  // The inverse of m_ids.
+  truth_table_type m_columns[number_of_variables];      // The value of each variable for every assignment.
+  Expression m_registers[number_of_registers];
+  truth_table_type m_truth_tables[number_of_registers]; // The expected truth table of each register.
+  std::string m_cost_directory;                         // Where test_one_input saves inputs with only cost findings (if not empty).
+
+ public:
+  // Without a baseline nothing is flagged as slow or large.
+  FuzzHarness();
+  explicit FuzzHarness(Baseline const& baseline);
+
+  // Run the operations encoded in data; returns everything that was found.
+  std::vector<Finding> run(uint8_t const* data, size_t size);
+
+  // Same as run, but print the findings to std::cerr. Aborts on a wrong result; an input with only cost
+  // findings (slow, large or blow-up) is saved in the cost directory, if set. Always returns 0.
+  int test_one_input(uint8_t const* data, size_t size);
+
+  // Set the directory where test_one_input saves inputs with cost findings (it throws std::system_error if saving fails).
+  void set_cost_directory(std::string const& directory) { m_cost_directory = directory; }
+
+  // Run every file in paths (directories are scanned, not recursively) and print the findings to os.
+  // Returns the number of files that have findings.
+  size_t replay(std::vector<std::string> const& paths, std::ostream& os);
+
+  Baseline const& measured() const { return m_measured; }
+
+  // A baseline is stored as text, one line per operation; these throw std::system_error on I/O errors.
+  static Baseline load_baseline(std::string const& filename);
+  static void save_baseline(std::string const& filename, Baseline const& baseline);
+
+  static char const* name_of(operation_type operation);
+
+ private:
+  Product decode_product(uint8_t const* data) const;
+  truth_table_type truth_table(Product const& product) const;
+  truth_table_type truth_table(Expression const& expression) const;
+  void reset();
+  void save_input(uint8_t const* data, size_t size) const;
+};
+
+} // namespace boolean
@@ -0,0 +1,63 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief libFuzzer entry point that runs each input through a FuzzHarness.
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+// Build with clang and -fsanitize=fuzzer (libFuzzer provides main):
+//
+// make fuzz/fuzz_expression FUZZER_FLAGS=-fsanitize=fuzzer
+//
+// The baseline is read from the file that the environment variable BOOLEAN_EXPRESSION_FUZZ_BASELINE
+// refers to, if set (see fuzz/replay_corpus.cxx for how to make one). Inputs that are only slow,
+// large or a blow-up are saved in the directory BOOLEAN_EXPRESSION_FUZZ_COST_DIRECTORY, if set.
+
+#include "sys.h"
+#include "debug.h"
+#include "FuzzHarness.h"
+#include <cstdint>
+#include <cstdlib>
+
+namespace {
+
+boolean::FuzzHarness create_harness()
+{
+  char const* const baseline_filename = std::getenv("BOOLEAN_EXPRESSION_FUZZ_BASELINE");
+  boolean::FuzzHarness harness = baseline_filename ? boolean::FuzzHarness(boolean::FuzzHarness::load_baseline(baseline_filename)) : boolean::FuzzHarness();
+  if (char const* const cost_directory = std::getenv("BOOLEAN_EXPRESSION_FUZZ_COST_DIRECTORY"))
+    harness.set_cost_directory(cost_directory);
+  return harness;
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerInitialize(int* /*argc*/, char*** /*argv*/)
+{
+  Debug(NAMESPACE_DEBUG::init());
+  return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(uint8_t const* data, size_t size)
+{
+  static boolean::FuzzHarness harness = create_harness();
+  return harness.test_one_input(data, size);
+}
@@ -0,0 +1,84 @@
+// boolean-expression -- Indeterminate booleans as sum of product expressions.
+//
+//! @file
+//! @brief Replays a fuzzing corpus through a FuzzHarness, or makes a baseline from it.
+//
+// Copyright (C) 2017 - 2018  Carlo Wood.
+//
+// RSA-1024 0x624ACAD5 1997-01-26                    Sign & Encrypt
+// Fingerprint16 = 32 EC A7 B6 AC DB 65 A6  F6 F6 55 DD 1C DC FF 61
+//
+// This file is part of boolean-expression.
+//
+// boolean-expression is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// boolean-expression is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with boolean-expression.  If not, see <http://www.gnu.org/licenses/>.
+
+// Usage:
+//
+// replay_corpus [--baseline <baseline file>] <file or directory>...
+//   Run every input and print its findings. Without a baseline only wrong results are reported.
+//   The exit code is 1 if any input has findings.
+//
+// replay_corpus --calibrate <baseline file> <file or directory>...
+//   Run a known good corpus and write the largest cost ratios that were seen as a baseline.
+
+#include "sys.h"
+#include "debug.h"
+#include "FuzzHarness.h"
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char* argv[])
+{
+  Debug(NAMESPACE_DEBUG::init());
+
+  std::string baseline_filename;
+  bool calibrate = false;
+  int arg = 1;
+  if (arg + 1 < argc && (std::strcmp(argv[arg], "--baseline") == 0 || std::strcmp(argv[arg], "--calibrate") == 0))
+  {
+    calibrate = argv[arg][2] == 'c';
+    baseline_filename = argv[arg + 1];
+    arg += 2;
+  }
+  if (arg == argc)
+  {
+    std::cerr << "Usage: " << argv[0] << " [--baseline <file> | --calibrate <file>] <file or directory>...\n";
+    return 2;
+  }
+  std::vector<std::string> const paths(argv + arg, argv + argc);
+
+  try
+  {
+    using boolean::FuzzHarness;
+    if (calibrate)
+    {
+      FuzzHarness harness;
+      harness.replay(paths, std::cout);
+      FuzzHarness::save_baseline(baseline_filename, harness.measured());
+      return 0;
+    }
+    FuzzHarness harness = baseline_filename.empty() ? FuzzHarness() : FuzzHarness(FuzzHarness::load_baseline(baseline_filename));
+    size_t const failed = harness.replay(paths, std::cout);
+    std::cout << failed << " input(s) with findings.\n";
+    return failed ? 1 : 0;
+  }
+  catch (std::exception const& error)
+  {
+    std::cerr << argv[0] << ": " << error.what() << '\n';
+    return 2;
+  }
+}